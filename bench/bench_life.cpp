@@ -0,0 +1,269 @@
+// bench: measures Life::update() throughput across rules, boundaries, grid
+// sizes, fill densities and engines, and writes the results as JSON.
+
+#include "Life.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Stats {
+    double mean = 0, stddev = 0, min = 0, max = 0;
+};
+
+Stats summarize(const std::vector<double>& values) {
+    Stats s;
+    if (values.empty()) return s;
+
+    s.min = s.max = values[0];
+    for (double v : values) {
+        s.mean += v;
+        s.min = std::min(s.min, v);
+        s.max = std::max(s.max, v);
+    }
+    s.mean /= values.size();
+
+    if (values.size() > 1) {
+        double sum = 0;
+        for (double v : values) sum += (v - s.mean) * (v - s.mean);
+        s.stddev = std::sqrt(sum / (values.size() - 1));
+    }
+    return s;
+}
+
+std::string statsJson(const Stats& s) {
+    std::ostringstream out;
+    out << "{ \"mean\": " << s.mean << ", \"stddev\": " << s.stddev
+        << ", \"min\": " << s.min << ", \"max\": " << s.max << " }";
+    return out.str();
+}
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty()) items.push_back(item);
+    return items;
+}
+
+// The whole of text as a decimal number in minimum..maximum
+bool parseNumber(const std::string& text, long long minimum, long long maximum, long long& number) {
+    const char* start = text.c_str();
+    char* stop = nullptr;
+    errno = 0;
+    long long parsed = std::strtoll(start, &stop, 10);
+    if (stop == start || *stop != '\0' || errno == ERANGE || parsed < minimum || parsed > maximum)
+        return false;
+    number = parsed;
+    return true;
+}
+
+// The whole of text as a fill density in (0, 1]
+bool parseDensity(const std::string& text, float& density) {
+    const char* start = text.c_str();
+    char* stop = nullptr;
+    float parsed = std::strtof(start, &stop);
+    if (stop == start || *stop != '\0' || !(parsed > 0.0f && parsed <= 1.0f))
+        return false;
+    density = parsed;
+    return true;
+}
+
+void printUsage() {
+    std::cout <<
+        "Usage: bench [options]\n"
+        "  --sizes LIST        Cube edge lengths (default 32,64,128,256,512,1024).\n"
+        "  --densities LIST    Fill densities (default 0.01,0.05,0.1,0.25,0.5).\n"
+        "  --rules LIST        Rules (default Conway3D,Conway2D,Custom3D,Custom2D).\n"
+        "  --engines LIST      Engines (default auto).\n"
+        "  --toric LIST        Boundaries: 0, 1 or 0,1 (default 0,1).\n"
+        "  --threads N         Worker threads (default 1).\n"
+        "  --warmup N          Warm-up generations per case (default 2).\n"
+        "  --reps N            Timed repetitions per case (default 5).\n"
+        "  --generations N     Generations per repetition (default: ~64M cell updates).\n"
+        "  --out FILE          JSON output (default bench_results.json).\n"
+        "  --quick             Sizes 32,64,128, densities 0.01,0.1,0.5, 3 repetitions.\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<int> sizes = { 32, 64, 128, 256, 512, 1024 };
+    std::vector<float> densities = { 0.01f, 0.05f, 0.1f, 0.25f, 0.5f };
+    std::vector<LifeMode> modes = { LifeMode::Current3D, LifeMode::Conway2D, LifeMode::Custom3D, LifeMode::Custom2D };
+    std::vector<LifeEngine> engines = { LifeEngine::Auto };
+    std::vector<bool> torics = { false, true };
+    int threads = 1, warmup = 2, reps = 5;
+    long long fixedGenerations = 0;
+    std::string outPath = "bench_results.json";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << "\n";
+                printUsage();
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        auto invalid = [&](const std::string& text) {
+            std::cerr << "Invalid value for " << arg << ": " << text << "\n";
+            printUsage();
+            std::exit(2);
+        };
+        auto number = [&](long long minimum, long long maximum) -> long long {
+            std::string text = value();
+            long long parsed = 0;
+            if (!parseNumber(text, minimum, maximum, parsed)) invalid(text);
+            return parsed;
+        };
+
+        if (arg == "--help" || arg == "-h") { printUsage(); return 0; }
+        else if (arg == "--quick") {
+            sizes = { 32, 64, 128 };
+            densities = { 0.01f, 0.1f, 0.5f };
+            reps = 3;
+        }
+        else if (arg == "--sizes") {
+            std::string list = value();
+            sizes.clear();
+            for (auto& v : splitList(list)) {
+                long long size = 0;
+                if (!parseNumber(v, 1, 1 << 24, size)) invalid(v);
+                sizes.push_back(int(size));
+            }
+            if (sizes.empty()) invalid(list);
+        }
+        else if (arg == "--densities") {
+            std::string list = value();
+            densities.clear();
+            for (auto& v : splitList(list)) {
+                float density = 0;
+                if (!parseDensity(v, density)) invalid(v);
+                densities.push_back(density);
+            }
+            if (densities.empty()) invalid(list);
+        }
+        else if (arg == "--toric") {
+            torics.clear();
+            for (auto& v : splitList(value())) {
+                if (v != "0" && v != "1") invalid(v);
+                torics.push_back(v == "1");
+            }
+        }
+        else if (arg == "--rules") {
+            modes.clear();
+            for (auto& v : splitList(value())) {
+                LifeMode mode;
+                if (!Life::parseMode(v, mode)) { std::cerr << "Unknown rule: " << v << "\n"; return 2; }
+                modes.push_back(mode);
+            }
+        }
+        else if (arg == "--engines") {
+            engines.clear();
+            for (auto& v : splitList(value())) {
+                LifeEngine engine;
+                if (!Life::parseEngine(v, engine)) { std::cerr << "Unknown engine: " << v << "\n"; return 2; }
+                engines.push_back(engine);
+            }
+        }
+        else if (arg == "--threads") threads = int(number(1, INT_MAX));
+        else if (arg == "--warmup") warmup = int(number(0, INT_MAX));
+        else if (arg == "--reps") reps = int(number(1, INT_MAX));
+        else if (arg == "--generations") fixedGenerations = number(0, LLONG_MAX);
+        else if (arg == "--out") outPath = value();
+        else {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            printUsage();
+            return 2;
+        }
+    }
+
+    using Clock = std::chrono::steady_clock;
+    std::vector<std::string> results;
+
+    for (int size : sizes)
+        for (float density : densities)
+            for (LifeMode mode : modes)
+                for (bool toric : torics)
+                    for (LifeEngine engine : engines) {
+                        double cells = double(size) * size * size;
+                        long long generations = fixedGenerations > 0
+                            ? fixedGenerations
+                            : std::max(2LL, (long long)(64.0 * 1024 * 1024 / cells));
+
+                        Life seed(size, size, size);
+                        seed.setMode(mode);
+                        seed.setToric(toric);
+                        seed.setEngine(engine);
+                        seed.setThreadCount(threads);
+                        seed.randomize(density, 1234);
+
+                        std::vector<double> genRates, cellRates;
+                        Life life = seed;
+                        for (int rep = 0; rep < reps; ++rep) {
+                            // Every repetition starts from the same soup after the warm-up
+                            life = seed;
+                            for (int w = 0; w < warmup; ++w) life.update();
+
+                            auto start = Clock::now();
+                            for (long long g = 0; g < generations; ++g) life.update();
+                            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+                            double rate = seconds > 0 ? generations / seconds : 0.0;
+                            genRates.push_back(rate);
+                            cellRates.push_back(rate * cells);
+                        }
+
+                        Stats gen = summarize(genRates);
+                        Stats cell = summarize(cellRates);
+
+                        std::cout << size << "^3 " << Life::modeName(mode) << (toric ? " toric" : "")
+                                  << " density " << density << " " << Life::engineName(engine) << ": "
+                                  << gen.mean << " gen/s (+/- " << gen.stddev << "), "
+                                  << cell.mean << " cells/s" << std::endl;
+
+                        std::ostringstream json;
+                        json << "    { \"rule\": \"" << Life::modeName(mode) << "\""
+                             << ", \"toric\": " << (toric ? "true" : "false")
+                             << ", \"size\": " << size
+                             << ", \"density\": " << density
+                             << ", \"engine\": \"" << Life::engineName(engine) << "\""
+                             << ", \"finalEngine\": \"" << Life::engineName(life.getActiveEngine()) << "\""
+                             << ", \"generations\": " << generations
+                             << ", \"finalPopulation\": " << life.getPopulation()
+                             << ",\n      \"generationsPerSecond\": " << statsJson(gen)
+                             << ",\n      \"cellsPerSecond\": " << statsJson(cell) << " }";
+                        results.push_back(json.str());
+                    }
+
+    std::ofstream out(outPath);
+    if (!out.is_open()) {
+        std::cerr << "Failed to write " << outPath << std::endl;
+        return 1;
+    }
+
+    out << "{\n"
+        << "  \"threads\": " << threads << ",\n"
+        << "  \"warmup\": " << warmup << ",\n"
+        << "  \"repetitions\": " << reps << ",\n"
+        << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+        out << results[i] << (i + 1 < results.size() ? ",\n" : "\n");
+    out << "  ]\n}\n";
+
+    std::cout << "Wrote " << results.size() << " results to " << outPath << std::endl;
+    return 0;
+}
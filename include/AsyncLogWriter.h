@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "LifeLog.h"
+#include "LifeSnapshot.h"
+
+// What submit() does when the queue already holds queueDepth snapshots
+enum class LogFullPolicy {
+    Block,      // wait for the writer: every generation is logged
+    Drop,       // discard the new snapshot
+    Coalesce    // replace the newest queued snapshot with the new one
+};
+
+// Moves log encoding and disk I/O off the simulation thread. Callers hand
+// over immutable, shared snapshots; a background thread appends them to a
+// LifeLogWriter in order.
+class AsyncLogWriter {
+public:
+    explicit AsyncLogWriter(size_t queueDepth = 16, LogFullPolicy policy = LogFullPolicy::Block);
+    ~AsyncLogWriter();
+
+    // Waits for the writer to finish what is queued and open the new file;
+    // false if it could not be created
+    bool open(const std::string& path, int sizeX, int sizeY, int sizeZ, int keyframeInterval = 64);
+    void close();
+
+    // Returns false if the snapshot was dropped (Drop policy, or no log open)
+    bool submit(std::shared_ptr<const LifeSnapshot> snapshot);
+
+    // Blocks until everything submitted so far is on disk
+    void flush();
+
+    void setQueueDepth(size_t depth);
+    void setPolicy(LogFullPolicy policy);
+    LogFullPolicy getPolicy() const { return m_policy; }
+    bool isOpen() const { return m_open; }
+
+    // Counters since construction
+    uint64_t getQueued() const { return m_queued; }        // accepted by submit()
+    uint64_t getWritten() const { return m_written; }      // appended to the log
+    uint64_t getDropped() const { return m_dropped; }      // rejected by Drop
+    uint64_t getCoalesced() const { return m_coalesced; }  // replaced by Coalesce
+    uint64_t getBytesWritten() const { return m_bytes; }   // size of the current log
+    size_t getPending() const;
+
+    static const char* policyName(LogFullPolicy policy);
+    static bool parsePolicy(const std::string& name, LogFullPolicy& policy);
+
+private:
+    struct Job {
+        enum class Type { Open, Close, Append } type;
+        std::shared_ptr<const LifeSnapshot> snapshot;
+        std::string path;
+        int sizeX = 0, sizeY = 0, sizeZ = 0;
+        int keyframeInterval = 64;
+        uint64_t epoch = 0;
+    };
+
+    LifeLogWriter m_log; // writer thread only
+    std::deque<Job> m_jobs;
+    size_t m_snapshotsQueued = 0; // Append jobs in m_jobs
+    mutable std::mutex m_mutex;
+    std::condition_variable m_hasWork;
+    std::condition_variable m_hasRoom;
+    std::condition_variable m_idle;
+    bool m_busy = false;
+    bool m_stopping = false;
+    uint64_t m_epoch = 0; // bumped by every Open and Close job
+
+    std::atomic<size_t> m_queueDepth;
+    std::atomic<LogFullPolicy> m_policy;
+    std::atomic<bool> m_open{false}; // set under m_mutex; submit() queues only while true
+    std::atomic<uint64_t> m_queued{0};
+    std::atomic<uint64_t> m_written{0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_coalesced{0};
+    std::atomic<uint64_t> m_bytes{0};
+
+    std::thread m_thread;
+
+    void run();
+    void push(Job job);
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Life.h"
+
+struct TuneResult {
+    LifeEngine kernel;
+    int threads;
+    int slabRows;
+    double generationsPerSecond;
+};
+
+// Benchmarks kernel, thread count and slab size on a synthetic soup of the
+// requested size and writes the fastest configuration as a machine profile
+// that Life::loadProfile() applies at startup.
+class Autotuner {
+public:
+    Autotuner(int sizeX, int sizeY, int sizeZ);
+
+    // Minimum wall time spent measuring each candidate
+    void setMinSeconds(double seconds) { m_minSeconds = seconds; }
+
+    TuneResult run();
+    const std::vector<TuneResult>& getResults() const { return m_results; }
+
+    bool saveProfile(const std::string& path) const;
+
+private:
+    int m_sizeX, m_sizeY, m_sizeZ;
+    double m_minSeconds = 0.25;
+    Life m_soup;
+    TuneResult m_best;
+    std::vector<TuneResult> m_results;
+
+    TuneResult measure(LifeEngine kernel, int threads, int slabRows);
+};
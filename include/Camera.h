@@ -18,6 +18,13 @@ public:
     void setPosition(const glm::vec3& position);
     void setTarget(const glm::vec3& target);
 
+    // Orbit around the target, in degrees; what checkpoints save
+    float getYaw() const { return m_yaw; }
+    float getPitch() const { return m_pitch; }
+    float getDistance() const { return m_distance; }
+    const glm::vec3& getTarget() const { return m_target; }
+    void setOrbit(float yaw, float pitch, float distance);
+
 private:
     glm::vec3 m_position;
     glm::vec3 m_target;
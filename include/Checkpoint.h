@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "Life.h"
+#include "LifeSnapshot.h"
+
+// Viewer settings saved alongside the simulation. The core only stores
+// them; the GUI maps them onto its Coloring and Camera.
+struct ViewState {
+    int coloring = 0;           // ColoringPattern
+    float cameraYaw = -90.0f;
+    float cameraPitch = 0.0f;
+    float cameraDistance = 100.0f;
+    float cameraTarget[3] = { 0.0f, 0.0f, 0.0f };
+};
+
+// Complete state of a run: restoring it and stepping on produces the same
+// generations, and the same randomize() fills, as the run that saved it.
+//
+// File (little-endian): 88-byte "LIFC" header (dims, rule, boundary,
+// engine, view, generation, population, checksum), then the pattern name,
+// the generator state as text and the packed words.
+struct Checkpoint {
+    std::shared_ptr<const LifeSnapshot> grid; // cells, rule, boundary, generation
+    LifeEngine engine = LifeEngine::Auto;
+    std::string randomState;                  // Life::getRandomState()
+    std::string name;                         // pattern the run started from
+    ViewState view;
+
+    // Copies what it needs: the result can go to another thread while the
+    // simulation carries on
+    static Checkpoint capture(const Life& life, const std::string& name, const ViewState& view);
+    bool restore(Life& life) const;
+
+    // Written to <path>.tmp, synced to disk and renamed over path, so a
+    // crash leaves either the previous checkpoint or the new one
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+};
+
+// Saves checkpoints on a background thread. Only the newest waiting
+// checkpoint matters: one submitted while another still waits replaces it.
+class CheckpointWriter {
+public:
+    CheckpointWriter();
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    void submit(Checkpoint checkpoint, const std::string& path);
+    // Blocks until everything submitted so far is on disk
+    void flush();
+
+    uint64_t getWritten() const { return m_written; }
+    uint64_t getReplaced() const { return m_replaced; }
+    uint64_t getFailed() const { return m_failed; }
+    double getLastSeconds() const { return m_lastSeconds; }
+
+private:
+    Checkpoint m_pending;
+    std::string m_pendingPath;
+    bool m_hasPending = false;
+    bool m_busy = false;
+    bool m_stopping = false;
+    std::mutex m_mutex;
+    std::condition_variable m_hasWork;
+    std::condition_variable m_idle;
+
+    std::atomic<uint64_t> m_written{0};
+    std::atomic<uint64_t> m_replaced{0};
+    std::atomic<uint64_t> m_failed{0};
+    std::atomic<double> m_lastSeconds{0.0};
+
+    std::thread m_thread;
+
+    void run();
+};
@@ -1,6 +1,8 @@
 #pragma once
 #include <glm/glm.hpp>
-#include "Life.h"
+#include <atomic>
+#include <cstdint>
+#include "LifeSnapshot.h"
 
 struct Color {
     float r, g, b;
@@ -16,13 +18,33 @@ enum class ColoringPattern {
 class Coloring {
 public:
     Coloring(int radius = 1, ColoringPattern pattern = ColoringPattern::Heatmap);
+    // Set from the simulation thread while the render thread reads it
     void setPattern(ColoringPattern pattern) { m_pattern = pattern; }
+    ColoringPattern getPattern() const { return m_pattern; }
+    int getRadius() const { return m_radius; }
 
-    Color getColor(const Life&, int, int, int) const;
+    Color getColor(const LifeSnapshot&, int, int, int) const;
+
+    // The renderers store a shade byte per cell and look its color up in a
+    // kPaletteSize-entry palette on the GPU, so a new pattern only needs a
+    // new palette. The shade is the cell's density (clamped to kMaxDensity)
+    // or, for patterns that shadesByDepth(), its z position.
+    static const int kPaletteSize = 256;
+    static constexpr float kMaxDensity = 0.5f;
+
+    uint8_t getShade(const LifeSnapshot&, int x, int y, int z) const;
+    static bool shadesByDepth(ColoringPattern pattern) { return pattern == ColoringPattern::ZFade; }
+    static uint8_t densityShade(float density);
+
+    // kPaletteSize RGBA8 entries for a pattern
+    void buildPalette(ColoringPattern pattern, uint32_t* out) const;
+
+    // 8 bits per channel, red in the low byte, opaque
+    static uint32_t toRGBA8(const Color& c);
 
 private:
     int m_radius;
-    ColoringPattern m_pattern;
+    std::atomic<ColoringPattern> m_pattern;
 
     // Original heatmap interpolation using thresholds
     Color densityToHeatmap(float density) const;
@@ -31,7 +53,7 @@ private:
     Color densityToGrayscale(float density) const;
 
     // NEW — fade based on z index
-    Color zFadeColor(const Life&, int z) const;
+    Color zFadeColor(const LifeSnapshot&, int z) const;
 
     // NEW — shimmering blue pulse using density
     Color bluePulseColor(float density) const;
@@ -0,0 +1,52 @@
+#pragma once
+#include <functional>
+#include <vector>
+#include "Life.h"
+
+enum class CommandType {
+    Clear,
+    Randomize,
+    Step,
+    SetMode,
+    SetToric,
+    SetEngine,
+    SetCells,   // batch of cell edits applied in one pass
+    Apply       // arbitrary function run on the simulation thread
+};
+
+// A request to change the simulation, posted from any thread and applied by
+// the simulation thread between generations.
+struct Command {
+    CommandType type = CommandType::Apply;
+    LifeMode mode = LifeMode::Current3D;
+    LifeEngine engine = LifeEngine::Auto;
+    bool toric = false;
+    std::vector<CellEdit> cells;
+    std::function<void(Life&)> apply;
+
+    static Command clear()                      { return make(CommandType::Clear); }
+    static Command randomize()                  { return make(CommandType::Randomize); }
+    static Command step()                       { return make(CommandType::Step); }
+    static Command setMode(LifeMode mode)       { Command c = make(CommandType::SetMode); c.mode = mode; return c; }
+    static Command setToric(bool toric)         { Command c = make(CommandType::SetToric); c.toric = toric; return c; }
+    static Command setEngine(LifeEngine engine) { Command c = make(CommandType::SetEngine); c.engine = engine; return c; }
+
+    static Command setCells(std::vector<CellEdit> cells) {
+        Command c = make(CommandType::SetCells);
+        c.cells = std::move(cells);
+        return c;
+    }
+
+    static Command run(std::function<void(Life&)> fn) {
+        Command c = make(CommandType::Apply);
+        c.apply = std::move(fn);
+        return c;
+    }
+
+private:
+    static Command make(CommandType type) {
+        Command c;
+        c.type = type;
+        return c;
+    }
+};
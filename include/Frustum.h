@@ -0,0 +1,15 @@
+#pragma once
+#include <glm/glm.hpp>
+
+// The six clip planes of a view-projection matrix, for rejecting whole
+// chunks before they are drawn
+class Frustum {
+public:
+    explicit Frustum(const glm::mat4& viewProjection);
+
+    // False only if the box is entirely outside one of the planes
+    bool intersects(const glm::vec3& min, const glm::vec3& max) const;
+
+private:
+    glm::vec4 m_planes[6]; // xyz points inwards; inside where dot(xyz, p) + w >= 0
+};
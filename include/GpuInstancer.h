@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "Shader.h"
+#include "LifeSnapshot.h"
+#include "Coloring.h"
+#include "InstanceBuffer.h"
+
+// Builds the renderer's instances on the GPU. Each rebuild uploads the
+// packed grid as-is (1 bit per cell) into a shader storage buffer; compute
+// passes then count the live cells per word, prefix-sum the counts and
+// write one PackedInstance per live cell at its offset. The words are
+// visited chunk by chunk (kInstanceChunk^3 cells), so every chunk's
+// instances are contiguous and get their own indirect draw command; the
+// renderer culls chunks by drawing only some commands. The CPU never
+// visits a cell.
+//
+// Needs only core GL 4.3 (compute shaders, SSBOs, indirect draws), so it
+// also runs on Mesa's software rasterizers.
+class GpuInstancer {
+public:
+    GpuInstancer() = default;
+    ~GpuInstancer();
+
+    GpuInstancer(const GpuInstancer&) = delete;
+    GpuInstancer& operator=(const GpuInstancer&) = delete;
+
+    static bool isSupported();
+
+    // Compiles the compact_*.glsl compute shaders from shaderDir
+    bool load(const std::string& shaderDir);
+    bool isReady() const { return m_ready; }
+
+    // bitsX/bitsY give the PackedInstance::cell layout, as in the CPU path
+    void build(const LifeSnapshot& life, const Coloring& coloring, int bitsX, int bitsY);
+
+    // Instances as a vertex buffer, and one DrawElementsIndirectCommand per
+    // chunk, x fastest: chunk (cx, cy, cz) is command (cz * chunksY + cy) * chunksX + cx
+    GLuint getInstanceVBO() const { return m_instances; }
+    GLuint getCommandBuffer() const { return m_commands; }
+    size_t getCapacity() const { return m_capacity; }
+    int getChunksX() const { return m_chunksX; }
+    int getChunksY() const { return m_chunksY; }
+    int getChunksZ() const { return m_chunksZ; }
+
+private:
+    Shader m_count, m_scan, m_add, m_emit, m_commandPass;
+    bool m_ready = false;
+
+    GLuint m_grid = 0;
+    GLuint m_offsets = 0;
+    GLuint m_instances = 0;
+    GLuint m_commands = 0;
+    std::vector<GLuint> m_sums; // block totals, one buffer per scan level
+    size_t m_words = 0;         // 32-bit grid words the buffers are sized for
+    size_t m_slots = 0;         // scanned words: every chunk padded to full size
+    size_t m_capacity = 0;      // instances
+    int m_chunksX = 0, m_chunksY = 0, m_chunksZ = 0;
+
+    void resize(const LifeSnapshot& life);
+    void scan(size_t level, GLuint data, size_t count);
+    static void dispatch(size_t groups);
+};
@@ -1,21 +1,73 @@
 #pragma once
+#include <cstdint>
 #include <vector>
-#include <glm/glm.hpp>
 #include <glad/glad.h>
 
+// One drawn cell, 8 bytes. The cell coordinates are bit fields of a single
+// word (x | y << bitsX | z << (bitsX + bitsY), widths chosen per grid) that
+// vertex.glsl takes apart again; the low byte of shade indexes the palette
+// (see Coloring::getShade), the rest is padding.
+struct PackedInstance {
+    uint32_t cell;
+    uint32_t shade;
+};
+
+// The renderers lay instances out chunk by chunk, kInstanceChunk cells per
+// side (one packed word wide), so each chunk can be culled as a whole
+const int kInstanceChunk = 64;
+
+// Per-instance data streamed to the GPU.
+//
+// With GL 4.4 (or ARB_buffer_storage) the data lives in one persistently
+// mapped, coherent buffer split into kSegments segments. upload() writes
+// straight into the next segment once the fence of the draw that last read
+// it has signaled, so the CPU never waits on the frame in flight. Older
+// contexts orphan the buffer with glBufferData before each upload instead.
+//
+// Capacity follows the uploads: it doubles when an upload does not fit and
+// halves back after kShrinkAfter uploads in a row used under a quarter of it.
 class InstanceBuffer {
 public:
-    InstanceBuffer(size_t maxInstances);
+    static const int kSegments = 3;
+    static const size_t kMinCapacity = 4096;
+    static const int kShrinkAfter = 120;
+
+    explicit InstanceBuffer(size_t initialInstances = kMinCapacity);
     ~InstanceBuffer();
 
-    void uploadPositions(const std::vector<glm::vec3>& positions);
-    void uploadColors(const std::vector<glm::vec3>& colors);
+    InstanceBuffer(const InstanceBuffer&) = delete;
+    InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+    // Returns how many instances were stored
+    size_t upload(const std::vector<PackedInstance>& instances);
 
-    GLuint getPositionVBO() const { return m_positionVBO; }
-    GLuint getColorVBO() const { return m_colorVBO; }
+    // Call after each draw that read the current instances
+    void fence();
+
+    // The name changes when the capacity does: fetch it for every draw
+    GLuint getVBO() const { return m_VBO; }
+    // Byte offset of the current instances inside the VBO
+    GLintptr getOffset() const { return m_offset; }
+
+    size_t getCapacity() const { return m_capacity; }
+    size_t getResizeCount() const { return m_resizes; }
+    bool isPersistent() const { return m_persistent; }
 
 private:
-    GLuint m_positionVBO;
-    GLuint m_colorVBO;
-    size_t m_maxInstances;
+    GLuint m_VBO = 0;
+    size_t m_capacity = 0; // instances per segment
+    size_t m_resizes = 0;
+    int m_lowUploads = 0;
+
+    bool m_supportsStorage = false;
+    bool m_persistent = false;
+    PackedInstance* m_map = nullptr; // all segments, persistent path only
+    GLsync m_fences[kSegments] = {};
+    int m_segment = 0;
+    GLintptr m_offset = 0;
+
+    void allocate(size_t capacity);
+    void release();
+    void waitForSegment(int segment);
+    size_t capacityFor(size_t count) const;
 };
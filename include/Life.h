@@ -1,6 +1,11 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <iosfwd>
+#include <cstdint>
+#include <cstddef>
+#include <random>
+#include "WorkerPool.h"
 
 enum class LifeMode {
     Current3D,   // Your current 3D rules
@@ -9,16 +14,62 @@ enum class LifeMode {
     Custom2D     // New 2D variant rules
 };
 
+// Kernels used by Life::update(). They all share the same packed grid,
+// so switching between them never changes the result.
+enum class LifeEngine {
+    Dense,       // Scalar per-cell counting, one row at a time
+    Bitsliced,   // 64 cells per word using bitwise adders
+    Sparse,      // Only recomputes words next to last generation's changes
+    Auto         // Picks one of the above from density and activity
+};
+
+// One entry of the adaptive engine history
+struct EngineSwitch {
+    long long generation;
+    LifeEngine from;
+    LifeEngine to;
+    float density;   // live cells / total cells
+    float activity;  // changed words / total words
+};
+
+// One cell assignment of a batched edit
+struct CellEdit {
+    int x, y, z;
+    bool alive;
+};
+
+// Timing of the last Life::loadFromFile()
+struct LoadReport {
+    size_t bytes = 0;
+    double seconds = 0.0;
+    int layers = 0;
+    int threads = 0;
+    bool mapped = false; // memory-mapped rather than read into a buffer
+};
+
+class LifeSnapshot;
+
 class Life {
 public:
     Life(int sizeX, int sizeY, int sizeZ);
 
+    // 30% fill drawn from the grid's own generator (seeded per process)
     void randomize();
+    // Reproducible fill: each cell alive with the given probability
+    void randomize(float density, uint64_t seed);
+
+    // State of the generator behind randomize(), so checkpoints resume it
+    std::string getRandomState() const;
+    bool setRandomState(const std::string& state);
     void update();
     void clear();
 
     bool getCell(int x, int y, int z) const;
     void setCell(int x, int y, int z, bool state);
+    void setCells(const std::vector<CellEdit>& edits);
+    // Replaces size, cells and generation counter at once (logs, snapshots);
+    // words use the getWords() layout. Engine and threading are kept.
+    bool restore(int sizeX, int sizeY, int sizeZ, std::vector<uint64_t> words, long long generation);
 
     float computeDensity(int x, int y, int z, int radius) const;
 
@@ -26,23 +77,128 @@ public:
     int getSizeY() const { return m_sizeY; }
     int getSizeZ() const { return m_sizeZ; }
 
-    void setMode(LifeMode mode) { m_mode = mode; }
+    void setMode(LifeMode mode) { m_mode = mode; m_sparseValid = false; }
     LifeMode getMode() const { return m_mode; }
 
-    void setToric(bool toric) { m_toric = toric; }
+    void setToric(bool toric) { m_toric = toric; m_sparseValid = false; }
     bool isToric() const { return m_toric; }
 
+    // Engine selection. getEngine() is what was requested (possibly Auto),
+    // getActiveEngine() is the kernel that runs the next generation.
+    void setEngine(LifeEngine engine);
+    LifeEngine getEngine() const { return m_engine; }
+    LifeEngine getActiveEngine() const { return m_activeEngine; }
+    const std::vector<EngineSwitch>& getEngineHistory() const { return m_engineHistory; }
+
+    // Parallelism: rows are handed out to threads in slabs of slabRows
+    void setThreadCount(int threads);
+    int getThreadCount() const { return m_threads; }
+    void setSlabRows(int rows);
+    int getSlabRows() const { return m_slabRows; }
+
+    long long getGeneration() const { return m_generation; }
+    // Changes whenever any cell may have changed (steps, edits, loads)
+    uint64_t getRevision() const { return m_revision; }
+    size_t getPopulation() const;
+    size_t getChangedCells() const { return m_changedCells; }
+
+    // Packed storage: one bit per cell, each (y, z) row padded to whole words
+    const std::vector<uint64_t>& getWords() const { return m_grid; }
+    int getWordsPerRow() const { return m_wordsPerRow; }
+
+    // Copies the current generation into out, reusing its storage
+    void snapshot(LifeSnapshot& out) const;
+
+    // Per-machine tuning written by Autotuner: the full kernel Auto falls
+    // back to, thread count and slab size
+    void setTunedKernel(LifeEngine kernel);
+    LifeEngine getTunedKernel() const { return m_tunedKernel; }
+    bool loadProfile(const std::string& path);
+    static std::string machineProfilePath();
+
+    static const char* modeName(LifeMode mode);
+    static bool parseMode(const std::string& name, LifeMode& mode);
+    static const char* engineName(LifeEngine engine);
+    static bool parseEngine(const std::string& name, LifeEngine& engine);
+    // "<X>x<Y>x<Z>" with every size in 1..2^24
+    static bool parseDims(const std::string& text, int& x, int& y, int& z);
+
+    // Memory-maps IO/<filename>/initial.txt and parses its layers in parallel
     bool loadFromFile(const std::string& filename);
+    const LoadReport& getLastLoad() const { return m_lastLoad; }
+    // Logs one generation as IO/<baseName>/log/NNNNN.lifb (binary format)
     bool saveToFile(const std::string& baseName, int step);
+    // Writes the grid in the initial.txt format, without console echo
+    bool exportToFile(const std::string& path, const std::string& name) const;
+
+    // Versioned binary snapshot: a 64-byte header (dims, rule, boundary,
+    // generation, population, checksum) followed by the packed words.
+    // loadBinary() leaves the grid untouched if the file fails validation.
+    bool saveBinary(const std::string& path) const;
+    bool loadBinary(const std::string& path);
+
+    // Golly RLE: "x = X, y = Y, rule = B3/S23" header, runs of b/o, '$' ends
+    // a row and '!' the pattern. A "z = Z" header field and '/' between planes
+    // extend it to layers. Runs go straight to and from packed words; a
+    // recognised rule sets the mode and a ":T" suffix the toric boundary.
+    bool loadRLE(const std::string& path);
+    bool saveRLE(const std::string& path, const std::string& name) const;
+
+    // The initial.txt text layout, as written by exportToFile()
+    void print(std::ostream& out, const std::string& name) const;
+
+    // Also print each logged generation to the console (off by default)
+    void setConsoleEcho(bool echo) { m_consoleEcho = echo; }
+    bool getConsoleEcho() const { return m_consoleEcho; }
 
 private:
     int m_sizeX, m_sizeY, m_sizeZ;
-    std::vector<bool> m_grid, m_next;
+    int m_wordsPerRow = 0;
+    std::vector<uint64_t> m_grid, m_next;
     LifeMode m_mode = LifeMode::Current3D;
     bool m_toric = false; // toric wrap-around flag
+    bool m_consoleEcho = false;
+    LoadReport m_lastLoad;
+    std::mt19937_64 m_random;
 
+    LifeEngine m_engine = LifeEngine::Bitsliced;
+    LifeEngine m_activeEngine = LifeEngine::Bitsliced;
+    LifeEngine m_tunedKernel = LifeEngine::Auto; // Auto: pick by grid width
+    std::vector<EngineSwitch> m_engineHistory;
+    int m_policyStreak = 0;
+
+    int m_threads = 1;
+    int m_slabRows = 16;
+    WorkerPool m_pool; // slab workers, kept between generations
+
+    long long m_generation = 0;
+    uint64_t m_revision = 0;
+    mutable size_t m_population = 0;
+    mutable bool m_populationValid = true;
+    size_t m_changedCells = 0;
+    size_t m_changedWordCount = 0;
+
+    // Sparse engine state: words that changed in the last generation
+    std::vector<size_t> m_changedWords;
+    std::vector<uint8_t> m_activeMark;
+    bool m_sparseValid = false;
+
+    // Rows of one L<z> section of an initial.txt file
+    struct TextSection {
+        const char* begin;
+        const char* end;
+    };
+
+    void allocate(int sizeX, int sizeY, int sizeZ);
+    void parseLayer(const TextSection& section, int z);
     bool isValidPosition(int x, int y, int z) const;
-    int countNeighbors(int x, int y, int z) const;
-    int countNeighbors2D(int x, int y, int z) const;
-    int getIndex(int x, int y, int z) const;
+    size_t wordIndex(int x, int y, int z) const;
+    int gatherRows(int y, int z, const uint64_t* rows[9]) const;
+
+    void updateDense();
+    void updateBitsliced();
+    void updateSparse();
+    void collectChanges();
+    void chooseEngine();
+    LifeEngine fullEngine() const;
 };
@@ -0,0 +1,124 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Life.h"
+#include "LifeSnapshot.h"
+
+// Append-only generation log. Every keyframeInterval-th frame is stored in
+// full, the ones in between as the XOR with the previous frame. Both are
+// written as (run of unchanged words, changed word) pairs, so a frame costs
+// roughly 9 bytes per changed word instead of a full grid copy; frames where
+// that would be larger than the grid store every word instead.
+//
+// File: "LIFL" header (dims, keyframe interval), then frames of
+//   type u8 (1 keyframe, 2 delta, | 0x80 every word), mode u8, toric u8,
+//   varint generation, varint population, varint payload size,
+//   u32 payload checksum, payload: (varint skipped words, u64 word)*
+//
+// close() also writes <path>.idx, a fixed-size entry per frame, so readers
+// can skip scanning the log. It is ignored once the log size no longer
+// matches (a crash, or frames appended later).
+class LifeLogWriter {
+public:
+    LifeLogWriter() = default;
+    ~LifeLogWriter();
+
+    // Truncates path and writes the file header
+    bool open(const std::string& path, int sizeX, int sizeY, int sizeZ, int keyframeInterval = 64);
+    void close();
+    bool isOpen() const { return m_out.is_open(); }
+
+    // Fails if the grid size differs from the one the log was opened with
+    bool append(const Life& life);
+    bool append(const LifeSnapshot& snapshot);
+
+    size_t getFrameCount() const { return m_index.size(); }
+    uint64_t getBytesWritten() const { return m_bytes; }
+
+private:
+    // One frame of the .idx file
+    struct IndexEntry {
+        uint64_t offset;     // payload position in the file
+        uint64_t size;
+        long long generation;
+        uint64_t population;
+        uint32_t checksum;
+        uint8_t type;        // frame type byte, raw flag included
+        LifeMode mode;
+        bool toric;
+    };
+
+    std::ofstream m_out;
+    std::string m_path;
+    int m_sizeX = 0, m_sizeY = 0, m_sizeZ = 0;
+    int m_keyframeInterval = 64;
+    uint64_t m_bytes = 0;
+    std::vector<IndexEntry> m_index;
+    std::vector<uint64_t> m_previous;
+    std::vector<unsigned char> m_payload;
+
+    bool appendFrame(int sizeX, int sizeY, int sizeZ, const std::vector<uint64_t>& words,
+                     long long generation, size_t population, LifeMode mode, bool toric);
+    void writeIndex();
+};
+
+// Random access over a log: open() loads the .idx index or scans every frame
+// header, read() decodes from the nearest keyframe, or from the last frame
+// read when that is closer. Deltas are XORs, so stepping back from the last
+// frame read undoes one delta instead of decoding from a keyframe.
+class LifeLogReader {
+public:
+    bool open(const std::string& path);
+    void close();
+
+    size_t getFrameCount() const { return m_frames.size(); }
+    int getSizeX() const { return m_sizeX; }
+    int getSizeY() const { return m_sizeY; }
+    int getSizeZ() const { return m_sizeZ; }
+    int getKeyframeInterval() const { return m_keyframeInterval; }
+    long long getGeneration(size_t frame) const { return m_frames[frame].generation; }
+    uint64_t getPopulation(size_t frame) const { return m_frames[frame].population; }
+    bool isKeyframe(size_t frame) const { return m_frames[frame].keyframe; }
+    bool usedIndex() const { return m_usedIndex; }
+
+    // Last frame whose generation is at or before generation (the first
+    // frame if none is), or -1 for an empty log
+    long long findFrame(long long generation) const;
+
+    // Reconstructs frame into words (getWords() layout)
+    bool readWords(size_t frame, std::vector<uint64_t>& words);
+    // Reconstructs frame into life, including its rule and boundary
+    bool read(size_t frame, Life& life);
+
+private:
+    struct Frame {
+        uint64_t offset;     // payload position in the file
+        uint64_t size;
+        bool keyframe;
+        bool raw;
+        LifeMode mode;
+        bool toric;
+        long long generation;
+        uint64_t population;
+        uint32_t checksum;
+    };
+
+    std::ifstream m_in;
+    std::string m_path;
+    int m_sizeX = 0, m_sizeY = 0, m_sizeZ = 0;
+    int m_keyframeInterval = 0;
+    std::vector<Frame> m_frames;
+    bool m_ascending = true; // generations only grow: findFrame() can bisect
+    bool m_usedIndex = false;
+
+    // Last decoded frame, reused when reading forward
+    std::vector<uint64_t> m_current;
+    long long m_currentFrame = -1;
+    std::vector<unsigned char> m_payload;
+
+    bool applyFrame(size_t frame);
+    bool loadIndex(const std::string& path, uint64_t logSize);
+    void scanFrames(uint64_t headerSize, uint64_t logSize);
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "Life.h"
+
+// Immutable copy of one generation, published by the simulation thread for
+// the renderer. Same layout and read API as Life.
+class LifeSnapshot {
+public:
+    bool getCell(int x, int y, int z) const;
+    float computeDensity(int x, int y, int z, int radius) const;
+
+    int getSizeX() const { return m_sizeX; }
+    int getSizeY() const { return m_sizeY; }
+    int getSizeZ() const { return m_sizeZ; }
+
+    LifeMode getMode() const { return m_mode; }
+    bool isToric() const { return m_toric; }
+    long long getGeneration() const { return m_generation; }
+    uint64_t getRevision() const { return m_revision; }
+    size_t getPopulation() const { return m_population; }
+
+    const std::vector<uint64_t>& getWords() const { return m_words; }
+    int getWordsPerRow() const { return m_wordsPerRow; }
+
+private:
+    friend class Life; // fills it in Life::snapshot()
+    friend struct Checkpoint; // and Checkpoint::load()
+
+    int m_sizeX = 0, m_sizeY = 0, m_sizeZ = 0;
+    int m_wordsPerRow = 0;
+    LifeMode m_mode = LifeMode::Current3D;
+    bool m_toric = false;
+    long long m_generation = 0;
+    uint64_t m_revision = 0;
+    size_t m_population = 0;
+    std::vector<uint64_t> m_words;
+
+    bool isValidPosition(int x, int y, int z) const;
+};
@@ -0,0 +1,37 @@
+#pragma once
+#include <string>
+#include "Life.h"
+#include "LifeLog.h"
+
+// Plays a generation log back into a Life instead of simulating it. Any
+// generation is reached by decoding at most one keyframe interval of
+// frames; stepping in either direction costs one frame.
+class LogReplay {
+public:
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return m_open; }
+
+    // Shows the last logged generation at or before generation
+    bool seek(long long generation, Life& life);
+    bool seekFrame(size_t frame, Life& life);
+
+    // Moves one frame in the play direction; false at either end of the log
+    bool step(Life& life);
+
+    void setForward(bool forward) { m_forward = forward; }
+    bool isForward() const { return m_forward; }
+
+    size_t getFrame() const { return m_frame; }
+    size_t getFrameCount() const { return m_reader.getFrameCount(); }
+    long long getGeneration() const { return m_reader.getGeneration(m_frame); }
+    long long getFirstGeneration() const { return m_reader.getGeneration(0); }
+    long long getLastGeneration() const { return m_reader.getGeneration(getFrameCount() - 1); }
+    const LifeLogReader& getReader() const { return m_reader; }
+
+private:
+    LifeLogReader m_reader;
+    size_t m_frame = 0;
+    bool m_forward = true;
+    bool m_open = false;
+};
@@ -0,0 +1,80 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include "Shader.h"
+#include "LifeSnapshot.h"
+#include "Coloring.h"
+#include "Palette.h"
+
+// Draws the live cells as one surface mesh: only cube faces whose neighbor
+// is dead are emitted, so the inside of dense clusters costs nothing.
+//
+// The grid is meshed in chunks of kChunkX x kChunkY x kChunkZ cells (one
+// packed word wide). A new generation is diffed word by word against the
+// previous one and only chunks that a changed cell can affect (its own,
+// plus neighbors within the face and coloring radius) are re-meshed.
+// Chunks outside the view frustum are not drawn.
+class MeshRenderer {
+public:
+    static const int kChunkX = 64;
+    static const int kChunkY = 16;
+    static const int kChunkZ = 16;
+
+    MeshRenderer(Coloring& coloring, Palette& palette);
+    ~MeshRenderer();
+
+    MeshRenderer(const MeshRenderer&) = delete;
+    MeshRenderer& operator=(const MeshRenderer&) = delete;
+
+    void render(const LifeSnapshot& life, Shader& shader, const glm::mat4& view, const glm::mat4& projection);
+
+    size_t getFaceCount() const { return m_faces; }
+    size_t getChunkCount() const { return m_chunks.size(); }
+    uint64_t getChunkRebuildCount() const { return m_chunkRebuilds; }
+    size_t getCulledChunkCount() const { return m_culledChunks; }
+
+private:
+    struct Vertex {
+        float x, y, z;
+        uint32_t shade; // palette index in the low byte
+    };
+
+    struct Chunk {
+        GLuint vao = 0, vbo = 0, ebo = 0;
+        GLsizei indexCount = 0;
+        glm::vec3 min, max; // world-space bounds
+        size_t faces = 0;
+        bool dirty = true;
+    };
+
+    Coloring& m_coloring;
+    Palette& m_palette;
+    std::vector<Chunk> m_chunks;
+    int m_chunksX = 0, m_chunksY = 0, m_chunksZ = 0;
+
+    // What the meshes were built from
+    int m_sizeX = 0, m_sizeY = 0, m_sizeZ = 0;
+    bool m_toric = false;
+    bool m_byDepth = false; // Coloring::shadesByDepth
+    uint64_t m_revision = 0;
+    long long m_generation = -1;
+    bool m_valid = false;
+    std::vector<uint64_t> m_previous;
+
+    size_t m_faces = 0;
+    uint64_t m_chunkRebuilds = 0;
+    size_t m_culledChunks = 0;
+
+    // Reused between chunk rebuilds
+    std::vector<Vertex> m_vertices;
+    std::vector<uint32_t> m_indices;
+    std::vector<int> m_rangeX, m_rangeY, m_rangeZ;
+
+    void reset(const LifeSnapshot& life);
+    void markChanges(const LifeSnapshot& life);
+    void markRange(int x0, int x1, int y0, int y1, int z0, int z1);
+    void rebuildChunk(const LifeSnapshot& life, int cx, int cy, int cz);
+    void releaseChunks();
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <utility>
+
+// Lock-free multi-producer / single-consumer queue (intrusive linked list
+// with a stub node). push() may be called from any thread, pop() only from
+// the consumer.
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() : m_head(new Node()), m_tail(m_head.load()) {}
+
+    ~MpscQueue() {
+        T discard;
+        while (pop(discard)) {}
+        delete m_tail;
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(T value) {
+        Node* node = new Node();
+        node->value = std::move(value);
+        Node* previous = m_head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    bool pop(T& out) {
+        Node* next = m_tail->next.load(std::memory_order_acquire);
+        if (!next) return false;
+
+        out = std::move(next->value);
+        delete m_tail;
+        m_tail = next; // becomes the new stub
+        return true;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value;
+    };
+
+    std::atomic<Node*> m_head; // last pushed node, shared by producers
+    Node* m_tail;              // stub node, owned by the consumer
+};
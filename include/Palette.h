@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <glad/glad.h>
+#include "Coloring.h"
+
+// The coloring's palette as a 1D RGBA8 texture, read by the shaders with
+// texelFetch(palette, shade). Rebuilt only when the pattern changes.
+class Palette {
+public:
+    explicit Palette(const Coloring& coloring);
+    ~Palette();
+
+    Palette(const Palette&) = delete;
+    Palette& operator=(const Palette&) = delete;
+
+    // Uploads a new palette if the pattern changed, then binds it to unit
+    void bind(int unit);
+
+    uint64_t getUploadCount() const { return m_uploads; }
+
+private:
+    const Coloring& m_coloring;
+    GLuint m_texture = 0;
+    bool m_valid = false;
+    ColoringPattern m_pattern = ColoringPattern::Heatmap;
+    uint64_t m_uploads = 0;
+};
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Scoped timing zones for finding where a frame or a generation goes.
+// Every thread records into its own fixed-size ring, so past a thread's
+// first zone recording never takes a lock or allocates; writeChromeTrace()
+// dumps all rings in the Chrome trace event format (chrome://tracing,
+// ui.perfetto.dev).
+//
+// The PROFILE_* macros compile to nothing unless LIFE_PROFILE is defined
+// (make PROFILE=1), so release builds pay nothing for the zones.
+class Profiler {
+public:
+    // Ring slots per thread; older events are overwritten
+    static constexpr size_t kRingSize = 1 << 16;
+
+    static constexpr bool enabled() {
+#ifdef LIFE_PROFILE
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // Monotonic clock used by all zones, in nanoseconds
+    static int64_t now();
+
+    // Appends a finished zone to the calling thread's ring. name must
+    // outlive the export (a string literal).
+    static void record(const char* name, int64_t startNs, int64_t endNs);
+
+    // Label for the calling thread in the exported trace
+    static void setThreadName(const std::string& name);
+
+    // Writes every thread's recorded zones; safe while threads keep recording
+    static bool writeChromeTrace(const std::string& path);
+
+    // Drops everything recorded so far
+    static void clear();
+};
+
+// Records the time between its construction and destruction
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name) : m_name(name), m_start(Profiler::now()) {}
+    ~ProfileZone() { Profiler::record(m_name, m_start, Profiler::now()); }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* m_name;
+    int64_t m_start;
+};
+
+#ifdef LIFE_PROFILE
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone_, __LINE__)(name)
+#define PROFILE_THREAD(name) Profiler::setThreadName(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#endif
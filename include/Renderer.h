@@ -1,20 +1,100 @@
 #pragma once
 #include <glm/glm.hpp>
+#include <atomic>
+#include <cstdint>
 #include <vector>
 #include "Shader.h"
 #include "Cell.h"
 #include "InstanceBuffer.h"
-#include "Life.h"
+#include "GpuInstancer.h"
+#include "LifeSnapshot.h"
 #include "Coloring.h"
+#include "Palette.h"
 
+// Draws one instanced cube per live cell. Instances are grouped into
+// kInstanceChunk^3 chunks; chunks outside the view frustum are skipped and,
+// on the CPU path, far chunks are drawn as 2x2x2 or 4x4x4 occupancy blocks
+// once a cell would cover fewer than kLodMinPixels pixels.
 class Renderer {
 public:
-    Renderer(Cell& cell, InstanceBuffer& instanceBuffer, Coloring& heatmap);
+    static const int kLodLevels = 3; // cells, 2^3 blocks, 4^3 blocks
+    static constexpr float kLodMinPixels = 2.0f;
 
-    void render(const Life& life, Shader& shader, const glm::mat4& view, const glm::mat4& projection);
+    Renderer(Cell& cell, InstanceBuffer& instanceBuffer, Coloring& heatmap, Palette& palette);
+
+    // Rebuilds and uploads instances only when the cells, the boundary or the
+    // kind of shade changed since the last call; otherwise redraws the GPU
+    // copy. A new coloring pattern only swaps the palette.
+    void render(const LifeSnapshot& life, Shader& shader, const glm::mat4& view, const glm::mat4& projection);
+
+    // Build instances with compute passes when gpu is ready; may be called
+    // from any thread, the switch happens on the next render()
+    void setGpuInstancer(GpuInstancer* gpu) { m_gpu = gpu; }
+    void setGpuInstancing(bool enabled) { m_useGpu = enabled; }
+    bool isGpuInstancing() const { return m_useGpu && m_gpu && m_gpu->isReady(); }
+
+    // Screen height used to pick the level of detail; 0 draws only cells
+    void setViewportHeight(int pixels) { m_viewportHeight = pixels; }
+
+    size_t getInstanceCount() const { return m_instanceCount; }
+    size_t getDrawnInstanceCount() const { return m_drawnInstances; } // CPU path
+    size_t getCulledChunkCount() const { return m_culledChunks; }
+    uint64_t getRebuildCount() const { return m_rebuilds; }
 
 private:
     Cell& m_cell;
     InstanceBuffer& m_instanceBuffer;
     Coloring& m_heatmap;
-};
\ No newline at end of file
+    Palette& m_palette;
+    GpuInstancer* m_gpu = nullptr;
+    std::atomic<bool> m_useGpu{true};
+
+    // What the uploaded instances were built from
+    struct CacheKey {
+        uint64_t revision = 0;
+        long long generation = -1;
+        int sizeX = 0, sizeY = 0, sizeZ = 0;
+        bool toric = false;
+        bool byDepth = false; // Coloring::shadesByDepth
+        bool gpu = false;
+
+        bool operator==(const CacheKey& o) const {
+            return revision == o.revision && generation == o.generation && sizeX == o.sizeX &&
+                   sizeY == o.sizeY && sizeZ == o.sizeZ && toric == o.toric && byDepth == o.byDepth &&
+                   gpu == o.gpu;
+        }
+    };
+    CacheKey m_key;
+    bool m_valid = false;
+    size_t m_instanceCount = 0;
+    uint64_t m_rebuilds = 0;
+    int m_viewportHeight = 0;
+    size_t m_drawnInstances = 0;
+    size_t m_culledChunks = 0;
+
+    // Instance ranges of one non-empty chunk, per level of detail
+    struct Chunk {
+        glm::vec3 min, max;  // world-space bounds
+        uint32_t first[kLodLevels];
+        uint32_t count[kLodLevels];
+    };
+    std::vector<Chunk> m_chunks;  // CPU path
+
+    // Shade sums of the coarse blocks while one chunk is built
+    struct Block {
+        uint32_t shades = 0;
+        uint32_t cells = 0;
+    };
+    std::vector<Block> m_blocks[kLodLevels];
+    std::vector<uint32_t> m_touched[kLodLevels];
+
+    // Reused between rebuilds so steady state allocates nothing
+    std::vector<PackedInstance> m_instances;
+    int m_bitsX = 0, m_bitsY = 0; // PackedInstance::cell layout for the current grid
+
+    void rebuild(const LifeSnapshot& life, bool gpu);
+    void buildChunk(const LifeSnapshot& life, int cx, int cy, int cz);
+    glm::vec3 chunkMin(int cx, int cy, int cz) const;
+    glm::vec3 chunkMax(int cx, int cy, int cz) const;
+    int levelFor(const Chunk& chunk, const glm::vec3& eye, const glm::mat4& projection) const;
+};
@@ -12,6 +12,7 @@ public:
     ~Shader();
     
     bool loadFromFile(const std::string& vertexPath, const std::string& fragmentPath);
+    bool loadComputeFromFile(const std::string& computePath);
     void use();
     void setUniform(const std::string& name, float value);
     void setUniform(const std::string& name, int value);
@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <thread>
+#include "Command.h"
+#include "Life.h"
+#include "LifeSnapshot.h"
+#include "MpscQueue.h"
+#include "TripleBuffer.h"
+
+// Runs Life::update() on its own thread and publishes every generation as
+// an immutable snapshot through a triple buffer, so rendering never waits
+// on the simulation and never sees a half-computed grid. Once started, the
+// simulation thread is the only one touching the Life; everything else
+// posts Commands that it drains between generations.
+class Simulation {
+public:
+    explicit Simulation(Life& life);
+    ~Simulation();
+
+    void start();
+    void stop();
+
+    // Generations per updateInterval; 0 pauses
+    void setSpeed(float speed) { m_speed = speed; }
+    float getSpeed() const { return m_speed; }
+    void setUpdateInterval(float seconds) { m_updateInterval = seconds; }
+
+    // Back-to-back generations, ignoring speed and updateInterval; snapshots
+    // are then published at most at display rate
+    void setMaxThroughput(bool enabled) { m_maxThroughput = enabled; }
+    bool isMaxThroughput() const { return m_maxThroughput; }
+
+    // Measured generations per second, refreshed about twice a second
+    float getGenerationsPerSecond() const { return m_generationsPerSecond; }
+
+    // Any thread: queue a command for the next generation boundary
+    void post(Command command);
+
+    // Any thread: block until everything posted so far has been applied
+    void waitForCommands();
+
+    // Called on the simulation thread after each generation (e.g. logging).
+    // Set it before start().
+    void setGenerationCallback(std::function<void(Life&)> callback);
+
+    // Replaces Life::update() as the way to reach the next generation (e.g.
+    // log replay); an empty function restores it. Set it before start().
+    void setStepFunction(std::function<void(Life&)> stepFunction);
+
+    // Render thread only: newest complete generation
+    const LifeSnapshot& latest() { return m_snapshots.acquire(); }
+
+private:
+    Life& m_life;
+    TripleBuffer<LifeSnapshot> m_snapshots;
+    MpscQueue<Command> m_commands;
+    std::function<void(Life&)> m_onGeneration;
+    std::function<void(Life&)> m_stepFunction;
+
+    std::atomic<bool> m_running{false};
+    std::atomic<float> m_speed{1.f};
+    std::atomic<float> m_updateInterval{0.5f};
+    std::atomic<bool> m_maxThroughput{false};
+    std::atomic<float> m_generationsPerSecond{0.f};
+    std::atomic<long long> m_posted{0};
+    std::atomic<long long> m_applied{0};
+    std::thread m_thread;
+
+    void run();
+    bool drainCommands();
+    void apply(Command& command);
+    void publish();
+    void step();
+    void advance();
+};
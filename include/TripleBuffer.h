@@ -0,0 +1,35 @@
+#pragma once
+#include <atomic>
+
+// Lock-free single-writer / single-reader triple buffer. The writer fills
+// back() and publish()es it; the reader's acquire() returns the newest
+// published value, which stays untouched until its next acquire().
+template <typename T>
+class TripleBuffer {
+public:
+    // Writer side
+    T& back() { return m_buffers[m_back]; }
+
+    void publish() {
+        int previous = m_middle.exchange(m_back | kFresh, std::memory_order_acq_rel);
+        m_back = previous & kIndex;
+    }
+
+    // Reader side
+    const T& acquire() {
+        if (m_middle.load(std::memory_order_relaxed) & kFresh) {
+            int previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+            m_front = previous & kIndex;
+        }
+        return m_buffers[m_front];
+    }
+
+private:
+    static constexpr int kIndex = 3;
+    static constexpr int kFresh = 4; // middle holds a value the reader has not seen
+
+    T m_buffers[3];
+    int m_back = 0;               // owned by the writer
+    std::atomic<int> m_middle{1}; // exchanged between both sides
+    int m_front = 2;              // owned by the reader
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include "Shader.h"
+#include "LifeSnapshot.h"
+#include "Coloring.h"
+#include "Palette.h"
+
+// Draws the grid by ray marching it in the fragment shader, so the cost of
+// a frame follows the number of pixels rather than the number of live cells.
+//
+// The packed grid is uploaded as it is, as a 3D R32UI texture of 32-cell
+// row segments. Next to it sits an occupancy pyramid: level 0 holds one
+// byte per kBrick^3 brick, each level above ORs 2x2x2 texels of the one
+// below. Rays step through the coarsest empty texels they can find and only
+// test single cells inside occupied bricks (hierarchical DDA).
+//
+// A new generation is diffed against the previous one; only the z slices
+// that changed are uploaded and only their bricks are recounted.
+class VolumeRenderer {
+public:
+    static const int kBrick = 8;
+
+    VolumeRenderer(Coloring& coloring, Palette& palette);
+    ~VolumeRenderer();
+
+    VolumeRenderer(const VolumeRenderer&) = delete;
+    VolumeRenderer& operator=(const VolumeRenderer&) = delete;
+
+    void render(const LifeSnapshot& life, Shader& shader, const glm::mat4& view, const glm::mat4& projection);
+
+    int getLevelCount() const { return int(m_levels.size()); }
+    uint64_t getUploadedSlices() const { return m_uploadedSlices; }
+
+private:
+    struct Level {
+        int sizeX = 0, sizeY = 0, sizeZ = 0; // powers of two
+        std::vector<uint8_t> texels;         // nonzero where any cell is live
+    };
+
+    Coloring& m_coloring;
+    Palette& m_palette;
+    GLuint m_cells = 0;
+    GLuint m_occupancy = 0;
+    GLuint m_vao = 0; // empty; the fullscreen triangle comes from gl_VertexID
+
+    // What the textures were built from
+    int m_sizeX = 0, m_sizeY = 0, m_sizeZ = 0;
+    int m_wordsPerRow = 0;
+    uint64_t m_revision = 0;
+    long long m_generation = -1;
+    bool m_valid = false;
+    bool m_tooLarge = false;
+    std::vector<uint64_t> m_previous;
+    std::vector<Level> m_levels;
+
+    uint64_t m_uploadedSlices = 0;
+
+    void reset(const LifeSnapshot& life);
+    void update(const LifeSnapshot& life);
+    void uploadSlices(const LifeSnapshot& life, int z0, int z1);
+    void countBricks(const LifeSnapshot& life, int bz0, int bz1);
+    void buildLevels(int bz0, int bz1);
+    void releaseTextures();
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Threads that stay parked between Life::update() calls, so a
+// multi-threaded generation costs a wake-up rather than a thread start.
+// Threads are started the first time a run needs them and kept until the
+// pool is destroyed.
+//
+// A copy starts empty and starts its own threads when first used: copies
+// of a Life may update on different threads at the same time.
+class WorkerPool {
+public:
+    WorkerPool() = default;
+    WorkerPool(const WorkerPool&) : WorkerPool() {}
+    WorkerPool& operator=(const WorkerPool&) { return *this; }
+    ~WorkerPool();
+
+    // Calls task on `workers` threads, the calling thread included, and
+    // returns once every call has returned
+    void run(int workers, const std::function<void()>& task);
+
+    int getThreadCount() const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    std::vector<std::thread> m_threads;
+    const std::function<void()>* m_task = nullptr;
+    uint64_t m_round = 0;   // bumped for every run that uses the threads
+    int m_helpers = 0;      // threads 0..m_helpers-1 take part in this round
+    int m_pending = 0;      // helpers still running this round's task
+    bool m_stopping = false;
+
+    void work(int index, uint64_t round);
+};
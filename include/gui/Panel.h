@@ -19,6 +19,7 @@ public:
     bool contains(const sf::Vector2f& point) const override;
     void handleClick(const sf::Vector2f& mousePos);
     void layoutButtons();
+    void setTitle(const std::string& title) { m_title.setString(title); }
 
     // Accessors needed for main.cpp
     sf::Vector2f getSize() const { return m_shape.getSize(); }
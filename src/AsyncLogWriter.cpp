@@ -0,0 +1,184 @@
+#include "AsyncLogWriter.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cctype>
+
+AsyncLogWriter::AsyncLogWriter(size_t queueDepth, LogFullPolicy policy)
+    : m_queueDepth(std::max<size_t>(1, queueDepth)), m_policy(policy)
+{
+    m_thread = std::thread(&AsyncLogWriter::run, this);
+}
+
+AsyncLogWriter::~AsyncLogWriter() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_hasWork.notify_all();
+    m_hasRoom.notify_all();
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void AsyncLogWriter::push(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Under the same lock as the job, so no Append can be queued behind
+        // it until the writer has opened the new file
+        m_open = false;
+        job.epoch = ++m_epoch;
+        m_jobs.push_back(std::move(job));
+    }
+    m_hasWork.notify_one();
+    m_hasRoom.notify_all();
+}
+
+bool AsyncLogWriter::open(const std::string& path, int sizeX, int sizeY, int sizeZ, int keyframeInterval) {
+    Job job;
+    job.type = Job::Type::Open;
+    job.path = path;
+    job.sizeX = sizeX;
+    job.sizeY = sizeY;
+    job.sizeZ = sizeZ;
+    job.keyframeInterval = keyframeInterval;
+    push(std::move(job));
+    flush();
+    return m_open;
+}
+
+void AsyncLogWriter::close() {
+    Job job;
+    job.type = Job::Type::Close;
+    push(std::move(job));
+}
+
+bool AsyncLogWriter::submit(std::shared_ptr<const LifeSnapshot> snapshot) {
+    if (!snapshot) return false;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        if (!m_open) return false;
+        if (m_snapshotsQueued < m_queueDepth || m_stopping) break;
+
+        LogFullPolicy policy = m_policy;
+        if (policy == LogFullPolicy::Block) {
+            // Also woken by close() and by a policy change, then looks again
+            m_hasRoom.wait(lock, [&] {
+                return m_snapshotsQueued < m_queueDepth || m_stopping || !m_open ||
+                       m_policy != LogFullPolicy::Block;
+            });
+            continue;
+        }
+        if (policy == LogFullPolicy::Drop) {
+            ++m_dropped;
+            return false;
+        }
+        if (!m_jobs.empty() && m_jobs.back().type == Job::Type::Append) {
+            m_jobs.back().snapshot = std::move(snapshot);
+            ++m_coalesced;
+            ++m_queued;
+            return true;
+        }
+        break;
+    }
+
+    Job job;
+    job.type = Job::Type::Append;
+    job.snapshot = std::move(snapshot);
+    m_jobs.push_back(std::move(job));
+    ++m_snapshotsQueued;
+    ++m_queued;
+    lock.unlock();
+    m_hasWork.notify_one();
+    return true;
+}
+
+void AsyncLogWriter::flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [&] { return (m_jobs.empty() && !m_busy) || m_stopping; });
+}
+
+void AsyncLogWriter::setQueueDepth(size_t depth) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queueDepth = std::max<size_t>(1, depth);
+    }
+    m_hasRoom.notify_all();
+}
+
+void AsyncLogWriter::setPolicy(LogFullPolicy policy) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_policy = policy;
+    }
+    m_hasRoom.notify_all();
+}
+
+size_t AsyncLogWriter::getPending() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_snapshotsQueued;
+}
+
+void AsyncLogWriter::run() {
+    PROFILE_THREAD("log writer");
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_hasWork.wait(lock, [&] { return !m_jobs.empty() || m_stopping; });
+        if (m_jobs.empty()) break; // stopping with nothing left to write
+
+        Job job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        if (job.type == Job::Type::Append) --m_snapshotsQueued;
+        m_busy = true;
+        lock.unlock();
+        m_hasRoom.notify_one();
+
+        bool opened = false;
+        switch (job.type) {
+            case Job::Type::Open:
+                opened = m_log.open(job.path, job.sizeX, job.sizeY, job.sizeZ, job.keyframeInterval);
+                m_bytes = m_log.getBytesWritten();
+                break;
+            case Job::Type::Close:
+                m_log.close();
+                break;
+            case Job::Type::Append: {
+                PROFILE_ZONE("AsyncLogWriter::append");
+                if (m_log.append(*job.snapshot)) ++m_written;
+                m_bytes = m_log.getBytesWritten();
+                break;
+            }
+        }
+        job.snapshot.reset();
+
+        lock.lock();
+        if (job.type == Job::Type::Open && job.epoch == m_epoch) m_open = opened;
+        m_busy = false;
+        if (m_jobs.empty()) m_idle.notify_all();
+    }
+
+    m_log.close();
+    m_idle.notify_all();
+}
+
+const char* AsyncLogWriter::policyName(LogFullPolicy policy) {
+    switch (policy) {
+        case LogFullPolicy::Block:    return "block";
+        case LogFullPolicy::Drop:     return "drop";
+        case LogFullPolicy::Coalesce: return "coalesce";
+    }
+    return "unknown";
+}
+
+bool AsyncLogWriter::parsePolicy(const std::string& name, LogFullPolicy& policy) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return char(std::tolower(c)); });
+
+    for (LogFullPolicy p : { LogFullPolicy::Block, LogFullPolicy::Drop, LogFullPolicy::Coalesce })
+        if (lower == policyName(p)) {
+            policy = p;
+            return true;
+        }
+    return false;
+}
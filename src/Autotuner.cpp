@@ -0,0 +1,101 @@
+#include "Autotuner.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <thread>
+
+Autotuner::Autotuner(int sizeX, int sizeY, int sizeZ)
+    : m_sizeX(sizeX), m_sizeY(sizeY), m_sizeZ(sizeZ), m_soup(sizeX, sizeY, sizeZ),
+      m_best{ LifeEngine::Bitsliced, 1, 16, 0.0 }
+{
+    // Same 30% soup for every candidate so the timings are comparable
+    std::mt19937 gen(12345);
+    std::uniform_real_distribution<> dis(0.0, 1.0);
+    for (int z = 0; z < m_sizeZ; ++z)
+        for (int y = 0; y < m_sizeY; ++y)
+            for (int x = 0; x < m_sizeX; ++x)
+                if (dis(gen) > 0.7f) m_soup.setCell(x, y, z, true);
+}
+
+TuneResult Autotuner::measure(LifeEngine kernel, int threads, int slabRows) {
+    Life life = m_soup;
+    life.setEngine(kernel);
+    life.setThreadCount(threads);
+    life.setSlabRows(slabRows);
+
+    life.update(); // warm-up
+
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    int generations = 0;
+    double elapsed = 0.0;
+    do {
+        life.update();
+        ++generations;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < m_minSeconds);
+
+    TuneResult result{ kernel, threads, slabRows, generations / elapsed };
+    m_results.push_back(result);
+
+    std::cout << "  " << Life::engineName(kernel) << ", " << threads << " thread(s), "
+              << slabRows << " rows per slab: " << result.generationsPerSecond << " gen/s" << std::endl;
+    return result;
+}
+
+// Staged search: kernel on one thread, then thread count with that kernel,
+// then slab size with that thread count
+TuneResult Autotuner::run() {
+    m_results.clear();
+    std::cout << "Autotuning on a " << m_sizeX << "x" << m_sizeY << "x" << m_sizeZ << " soup..." << std::endl;
+
+    auto better = [](const TuneResult& a, const TuneResult& b) {
+        return a.generationsPerSecond > b.generationsPerSecond;
+    };
+
+    TuneResult best = measure(LifeEngine::Dense, 1, 16);
+    TuneResult candidate = measure(LifeEngine::Bitsliced, 1, 16);
+    if (better(candidate, best)) best = candidate;
+
+    int cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> threadCounts;
+    for (int t = 2; t < cores; t *= 2) threadCounts.push_back(t);
+    if (cores > 1) threadCounts.push_back(cores);
+    for (int threads : threadCounts) {
+        candidate = measure(best.kernel, threads, best.slabRows);
+        if (better(candidate, best)) best = candidate;
+    }
+
+    for (int slabRows : { 1, 4, 64, 256 }) {
+        candidate = measure(best.kernel, best.threads, slabRows);
+        if (better(candidate, best)) best = candidate;
+    }
+
+    m_best = best;
+    std::cout << "Best: " << Life::engineName(best.kernel) << ", " << best.threads << " thread(s), "
+              << best.slabRows << " rows per slab (" << best.generationsPerSecond << " gen/s)" << std::endl;
+    return best;
+}
+
+bool Autotuner::saveProfile(const std::string& path) const {
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent);
+
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Failed to write profile: " << path << std::endl;
+        return false;
+    }
+
+    out << "# Written by autotune on a " << m_sizeX << "x" << m_sizeY << "x" << m_sizeZ << " soup\n";
+    out << "kernel=" << Life::engineName(m_best.kernel) << "\n";
+    out << "threads=" << m_best.threads << "\n";
+    out << "slabRows=" << m_best.slabRows << "\n";
+    out << "generationsPerSecond=" << m_best.generationsPerSecond << "\n";
+
+    std::cout << "Saved tuning profile to " << path << std::endl;
+    return true;
+}
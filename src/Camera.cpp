@@ -1,4 +1,5 @@
 #include "Camera.h"
+#include <algorithm>
 #include <cmath>
 #include <SFML/Window/Mouse.hpp>
 
@@ -81,4 +82,9 @@ void Camera::setPosition(const glm::vec3& position) {
 
 void Camera::setTarget(const glm::vec3& target) {
     m_target = target;
-}
\ No newline at end of file
+}
+void Camera::setOrbit(float yaw, float pitch, float distance) {
+    m_yaw = yaw;
+    m_pitch = std::max(-89.0f, std::min(89.0f, pitch));
+    if (distance > 0.0f) m_distance = distance;
+}
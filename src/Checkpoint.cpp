@@ -0,0 +1,355 @@
+#include "Checkpoint.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Header layout (all fields little-endian):
+//   0  "LIFC"          4  version u16      6  header size u16
+//   8  sizeX u32      12  sizeY u32       16  sizeZ u32      20  wordsPerRow u32
+//  24  mode u8        25  toric u8        26  engine u8      27  coloring u8
+//  28  camera yaw f32 32  pitch f32       36  distance f32   40  target x, y, z f32
+//  52  name length u32                    56  generation i64
+//  64  population u64 72  random state length u32
+//  80  FNV-1a 64 of the header (with this field zero) and everything after it
+//  88  name, random state, packed words u64
+const char kCheckpointMagic[4] = { 'L', 'I', 'F', 'C' };
+const uint16_t kCheckpointVersion = 2;
+const size_t kCheckpointHeaderSize = 88;
+
+void putLE(unsigned char* out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) out[i] = (unsigned char)(value >> (8 * i));
+}
+
+uint64_t getLE(const unsigned char* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) value |= uint64_t(in[i]) << (8 * i);
+    return value;
+}
+
+void putFloat(unsigned char* out, float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, 4);
+    putLE(out, bits, 4);
+}
+
+float getFloat(const unsigned char* in) {
+    uint32_t bits = uint32_t(getLE(in, 4));
+    float value;
+    std::memcpy(&value, &bits, 4);
+    return value;
+}
+
+bool hostIsLittleEndian() {
+    const uint16_t probe = 1;
+    return *reinterpret_cast<const unsigned char*>(&probe) == 1;
+}
+
+struct Fnv64 {
+    uint64_t hash = 1469598103934665603ull;
+
+    void add(const unsigned char* bytes, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    }
+
+    void add(const std::string& text) {
+        add(reinterpret_cast<const unsigned char*>(text.data()), text.size());
+    }
+
+    void add(const std::vector<uint64_t>& words) {
+        unsigned char bytes[8];
+        for (uint64_t w : words) {
+            putLE(bytes, w, 8);
+            add(bytes, 8);
+        }
+    }
+};
+
+// Flushes f's data to the device, not just to the OS
+bool syncFile(FILE* f) {
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+// Replaces to with from in one step and makes the rename itself durable
+bool replaceFile(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    if (std::rename(from.c_str(), to.c_str()) != 0) return false;
+    std::string dir = std::filesystem::path(to).parent_path().string();
+    int fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        ::close(fd);
+    }
+    return true;
+#endif
+}
+
+} // namespace
+
+Checkpoint Checkpoint::capture(const Life& life, const std::string& name, const ViewState& view) {
+    PROFILE_ZONE("Checkpoint::capture");
+    auto grid = std::make_shared<LifeSnapshot>();
+    life.snapshot(*grid);
+
+    Checkpoint checkpoint;
+    checkpoint.grid = std::move(grid);
+    checkpoint.engine = life.getEngine();
+    checkpoint.randomState = life.getRandomState();
+    checkpoint.name = name;
+    checkpoint.view = view;
+    return checkpoint;
+}
+
+bool Checkpoint::restore(Life& life) const {
+    if (!grid) return false;
+    if (!life.restore(grid->getSizeX(), grid->getSizeY(), grid->getSizeZ(), grid->getWords(), grid->getGeneration()))
+        return false;
+    life.setMode(grid->getMode());
+    life.setToric(grid->isToric());
+    life.setEngine(engine);
+    if (!randomState.empty() && !life.setRandomState(randomState))
+        std::cerr << "Warning: checkpoint generator state is unreadable, keeping the current one" << std::endl;
+    return true;
+}
+
+bool Checkpoint::save(const std::string& path) const {
+    PROFILE_ZONE("Checkpoint::save");
+    if (!grid) return false;
+
+    // Runs on the CheckpointWriter thread: failures are counted, never thrown
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    std::error_code error;
+    if (!parent.empty()) std::filesystem::create_directories(parent, error);
+
+    const std::vector<uint64_t>& words = grid->getWords();
+    unsigned char header[kCheckpointHeaderSize] = {};
+    std::copy(kCheckpointMagic, kCheckpointMagic + 4, header);
+    putLE(header + 4, kCheckpointVersion, 2);
+    putLE(header + 6, kCheckpointHeaderSize, 2);
+    putLE(header + 8, uint32_t(grid->getSizeX()), 4);
+    putLE(header + 12, uint32_t(grid->getSizeY()), 4);
+    putLE(header + 16, uint32_t(grid->getSizeZ()), 4);
+    putLE(header + 20, uint32_t(grid->getWordsPerRow()), 4);
+    header[24] = uint8_t(grid->getMode());
+    header[25] = grid->isToric() ? 1 : 0;
+    header[26] = uint8_t(engine);
+    header[27] = uint8_t(view.coloring);
+    putFloat(header + 28, view.cameraYaw);
+    putFloat(header + 32, view.cameraPitch);
+    putFloat(header + 36, view.cameraDistance);
+    for (int i = 0; i < 3; ++i) putFloat(header + 40 + 4 * i, view.cameraTarget[i]);
+    putLE(header + 52, uint32_t(name.size()), 4);
+    putLE(header + 56, uint64_t(grid->getGeneration()), 8);
+    putLE(header + 64, grid->getPopulation(), 8);
+    putLE(header + 72, uint32_t(randomState.size()), 4);
+
+    Fnv64 checksum;
+    checksum.add(header, kCheckpointHeaderSize);
+    checksum.add(name);
+    checksum.add(randomState);
+    checksum.add(words);
+    putLE(header + 80, checksum.hash, 8);
+
+    std::string temp = path + ".tmp";
+    FILE* f = std::fopen(temp.c_str(), "wb");
+    if (!f) {
+        std::cerr << "Failed to write file: " << temp << std::endl;
+        return false;
+    }
+
+    std::fwrite(header, 1, kCheckpointHeaderSize, f);
+    std::fwrite(name.data(), 1, name.size(), f);
+    std::fwrite(randomState.data(), 1, randomState.size(), f);
+    if (hostIsLittleEndian()) {
+        std::fwrite(words.data(), sizeof(uint64_t), words.size(), f);
+    } else {
+        unsigned char bytes[8];
+        for (uint64_t w : words) {
+            putLE(bytes, w, 8);
+            std::fwrite(bytes, 1, 8, f);
+        }
+    }
+
+    bool ok = !std::ferror(f) && std::fflush(f) == 0 && syncFile(f);
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok || !replaceFile(temp, path)) {
+        std::cerr << "Failed to write checkpoint: " << path << std::endl;
+        std::remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool Checkpoint::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "Failed to open file: " << path << std::endl;
+        return false;
+    }
+
+    unsigned char header[kCheckpointHeaderSize];
+    if (!in.read(reinterpret_cast<char*>(header), kCheckpointHeaderSize) ||
+        !std::equal(kCheckpointMagic, kCheckpointMagic + 4, header)) {
+        std::cerr << "Not a Life checkpoint: " << path << std::endl;
+        return false;
+    }
+
+    uint64_t version = getLE(header + 4, 2);
+    uint64_t headerSize = getLE(header + 6, 2);
+    if (version != kCheckpointVersion || headerSize < kCheckpointHeaderSize) {
+        std::cerr << "Unsupported checkpoint version " << version << ": " << path << std::endl;
+        return false;
+    }
+
+    int sizeX = int(getLE(header + 8, 4));
+    int sizeY = int(getLE(header + 12, 4));
+    int sizeZ = int(getLE(header + 16, 4));
+    int wordsPerRow = int(getLE(header + 20, 4));
+    uint64_t nameSize = getLE(header + 52, 4);
+    uint64_t randomSize = getLE(header + 72, 4);
+    if (sizeX <= 0 || sizeY <= 0 || sizeZ <= 0 || wordsPerRow != (sizeX + 63) / 64 ||
+        header[24] > uint8_t(LifeMode::Custom2D) || header[26] > uint8_t(LifeEngine::Auto)) {
+        std::cerr << "Invalid checkpoint header: " << path << std::endl;
+        return false;
+    }
+
+    // Check the payload is really there before allocating for it
+    size_t wordCount = size_t(wordsPerRow) * sizeY * sizeZ;
+    in.seekg(0, std::ios::end);
+    uint64_t fileSize = uint64_t(in.tellg());
+    uint64_t textSize = nameSize + randomSize;
+    if (fileSize < headerSize + textSize || (fileSize - headerSize - textSize) / sizeof(uint64_t) < wordCount) {
+        std::cerr << "Truncated checkpoint: " << path << std::endl;
+        return false;
+    }
+    in.seekg(std::streamoff(headerSize));
+
+    auto loaded = std::make_shared<LifeSnapshot>();
+    std::string loadedName(size_t(nameSize), '\0'), loadedRandom(size_t(randomSize), '\0');
+    in.read(&loadedName[0], std::streamsize(nameSize));
+    in.read(&loadedRandom[0], std::streamsize(randomSize));
+    loaded->m_words.resize(wordCount);
+    if (hostIsLittleEndian()) {
+        in.read(reinterpret_cast<char*>(loaded->m_words.data()), wordCount * sizeof(uint64_t));
+    } else {
+        unsigned char bytes[8];
+        for (uint64_t& w : loaded->m_words) {
+            in.read(reinterpret_cast<char*>(bytes), 8);
+            w = getLE(bytes, 8);
+        }
+    }
+
+    uint64_t stored = getLE(header + 80, 8);
+    putLE(header + 80, 0, 8);
+    Fnv64 checksum;
+    checksum.add(header, kCheckpointHeaderSize);
+    checksum.add(loadedName);
+    checksum.add(loadedRandom);
+    checksum.add(loaded->m_words);
+    if (!in || checksum.hash != stored) {
+        std::cerr << "Checkpoint checksum mismatch: " << path << std::endl;
+        return false;
+    }
+
+    loaded->m_sizeX = sizeX;
+    loaded->m_sizeY = sizeY;
+    loaded->m_sizeZ = sizeZ;
+    loaded->m_wordsPerRow = wordsPerRow;
+    loaded->m_mode = LifeMode(header[24]);
+    loaded->m_toric = header[25] != 0;
+    loaded->m_generation = (long long)getLE(header + 56, 8);
+    loaded->m_population = size_t(getLE(header + 64, 8));
+
+    grid = std::move(loaded);
+    engine = LifeEngine(header[26]);
+    randomState = std::move(loadedRandom);
+    name = std::move(loadedName);
+    view.coloring = header[27];
+    view.cameraYaw = getFloat(header + 28);
+    view.cameraPitch = getFloat(header + 32);
+    view.cameraDistance = getFloat(header + 36);
+    for (int i = 0; i < 3; ++i) view.cameraTarget[i] = getFloat(header + 40 + 4 * i);
+    return true;
+}
+
+CheckpointWriter::CheckpointWriter() {
+    m_thread = std::thread(&CheckpointWriter::run, this);
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_hasWork.notify_all();
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void CheckpointWriter::submit(Checkpoint checkpoint, const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_hasPending) ++m_replaced;
+        m_pending = std::move(checkpoint);
+        m_pendingPath = path;
+        m_hasPending = true;
+    }
+    m_hasWork.notify_one();
+}
+
+void CheckpointWriter::flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [&] { return !m_hasPending && !m_busy; });
+}
+
+void CheckpointWriter::run() {
+    PROFILE_THREAD("checkpoint writer");
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_hasWork.wait(lock, [&] { return m_hasPending || m_stopping; });
+        if (!m_hasPending) break; // stopping with nothing left to write
+
+        Checkpoint checkpoint = std::move(m_pending);
+        std::string path = std::move(m_pendingPath);
+        m_pending = Checkpoint();
+        m_hasPending = false;
+        m_busy = true;
+        lock.unlock();
+
+        auto started = std::chrono::steady_clock::now();
+        if (checkpoint.save(path)) ++m_written;
+        else ++m_failed;
+        m_lastSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        checkpoint = Checkpoint(); // drop the grid outside the lock
+
+        lock.lock();
+        m_busy = false;
+        if (!m_hasPending) m_idle.notify_all();
+    }
+    m_idle.notify_all();
+}
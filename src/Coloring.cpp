@@ -1,5 +1,4 @@
 #include "Coloring.h"
-#include "Life.h"
 #include <algorithm> // for std::clamp
 #include <cmath>     // for sin()
 
@@ -58,7 +57,7 @@ Color Coloring::densityToGrayscale(float density) const {
 // -------------------------------------------------------------
 // NEW: Fade from back (z=0) to front (z=max) : black → white
 // -------------------------------------------------------------
-Color Coloring::zFadeColor(const Life& life, int z) const {
+Color Coloring::zFadeColor(const LifeSnapshot& life, int z) const {
     int maxZ = life.getSizeZ() - 1;
     if (maxZ <= 0)
         return {0.0f, 0.0f, 0.0f};
@@ -84,7 +83,7 @@ Color Coloring::bluePulseColor(float density) const {
 // -------------------------------------------------------------
 // Main selector
 // -------------------------------------------------------------
-Color Coloring::getColor(const Life& life, int x, int y, int z) const {
+Color Coloring::getColor(const LifeSnapshot& life, int x, int y, int z) const {
     float density = life.computeDensity(x, y, z, m_radius);
 
     switch (m_pattern) {
@@ -103,3 +102,40 @@ Color Coloring::getColor(const Life& life, int x, int y, int z) const {
 
     return { 1.0f, 0.0f, 1.0f }; // fallback magenta
 }
+
+uint32_t Coloring::toRGBA8(const Color& c) {
+    auto channel = [](float v) { return uint32_t(std::clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f); };
+    return channel(c.r) | channel(c.g) << 8 | channel(c.b) << 16 | 0xFF000000u;
+}
+
+// -------------------------------------------------------------
+// Shades and palettes for the GPU-side lookup
+// -------------------------------------------------------------
+uint8_t Coloring::densityShade(float density) {
+    float t = std::clamp(density / kMaxDensity, 0.0f, 1.0f);
+    return uint8_t(t * (kPaletteSize - 1) + 0.5f);
+}
+
+uint8_t Coloring::getShade(const LifeSnapshot& life, int x, int y, int z) const {
+    if (shadesByDepth(m_pattern)) {
+        int maxZ = life.getSizeZ() - 1;
+        return maxZ > 0 ? uint8_t(float(z) / float(maxZ) * (kPaletteSize - 1) + 0.5f) : 0;
+    }
+    return densityShade(life.computeDensity(x, y, z, m_radius));
+}
+
+void Coloring::buildPalette(ColoringPattern pattern, uint32_t* out) const {
+    for (int i = 0; i < kPaletteSize; ++i) {
+        float t = float(i) / float(kPaletteSize - 1);
+        float density = t * kMaxDensity;
+
+        Color color = { 1.0f, 0.0f, 1.0f }; // fallback magenta
+        switch (pattern) {
+            case ColoringPattern::Heatmap:   color = densityToHeatmap(density); break;
+            case ColoringPattern::Grayscale: color = densityToGrayscale(density); break;
+            case ColoringPattern::ZFade:     color = { t, t, t }; break;
+            case ColoringPattern::BluePulse: color = bluePulseColor(density); break;
+        }
+        out[i] = toRGBA8(color);
+    }
+}
@@ -0,0 +1,24 @@
+#include "Frustum.h"
+
+Frustum::Frustum(const glm::mat4& m) {
+    // Gribb & Hartmann: each plane is the last row of the matrix plus or
+    // minus one of the others (glm is column-major, so row i is m[*][i])
+    auto row = [&](int i) { return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+    glm::vec4 r3 = row(3);
+    for (int i = 0; i < 3; ++i) {
+        m_planes[2 * i] = r3 + row(i);
+        m_planes[2 * i + 1] = r3 - row(i);
+    }
+}
+
+bool Frustum::intersects(const glm::vec3& min, const glm::vec3& max) const {
+    for (const glm::vec4& p : m_planes) {
+        // The corner furthest along the plane normal
+        glm::vec3 corner(p.x >= 0 ? max.x : min.x,
+                         p.y >= 0 ? max.y : min.y,
+                         p.z >= 0 ? max.z : min.z);
+        if (p.x * corner.x + p.y * corner.y + p.z * corner.z + p.w < 0)
+            return false;
+    }
+    return true;
+}
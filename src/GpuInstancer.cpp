@@ -0,0 +1,179 @@
+#include "GpuInstancer.h"
+#include "Profiler.h"
+#include <algorithm>
+
+namespace {
+
+const size_t kGroupSize = 256;        // local_size_x of every compact_*.glsl
+const size_t kMaxGroupsX = 65535;     // smallest GL_MAX_COMPUTE_WORK_GROUP_COUNT allowed
+
+// 32-bit words in one chunk: a 64-cell row is two, kInstanceChunk^2 rows
+const size_t kSlotsPerChunk = 2 * size_t(kInstanceChunk) * kInstanceChunk;
+
+size_t groupsFor(size_t count) {
+    return (count + kGroupSize - 1) / kGroupSize;
+}
+
+void allocateStorage(GLuint& buffer, size_t bytes, GLenum usage) {
+    if (!buffer) glGenBuffers(1, &buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, GLsizeiptr(std::max<size_t>(bytes, 4)), nullptr, usage);
+}
+
+} // namespace
+
+GpuInstancer::~GpuInstancer() {
+    for (GLuint* b : { &m_grid, &m_offsets, &m_instances, &m_commands })
+        if (*b) glDeleteBuffers(1, b);
+    if (!m_sums.empty()) glDeleteBuffers(GLsizei(m_sums.size()), m_sums.data());
+}
+
+bool GpuInstancer::isSupported() {
+    return GLAD_GL_VERSION_4_3;
+}
+
+bool GpuInstancer::load(const std::string& shaderDir) {
+    m_ready = isSupported() &&
+              m_count.loadComputeFromFile(shaderDir + "/compact_count.glsl") &&
+              m_scan.loadComputeFromFile(shaderDir + "/compact_scan.glsl") &&
+              m_add.loadComputeFromFile(shaderDir + "/compact_add.glsl") &&
+              m_emit.loadComputeFromFile(shaderDir + "/compact_emit.glsl") &&
+              m_commandPass.loadComputeFromFile(shaderDir + "/compact_commands.glsl");
+    return m_ready;
+}
+
+void GpuInstancer::dispatch(size_t groups) {
+    // Past kMaxGroupsX the shaders flatten a 2D grid of work groups
+    GLuint x = GLuint(std::min(groups, kMaxGroupsX));
+    GLuint y = GLuint((groups + x - 1) / x);
+    glDispatchCompute(x, y, 1);
+}
+
+void GpuInstancer::resize(const LifeSnapshot& life) {
+    size_t words = life.getWords().size() * 2;
+    int chunksX = life.getWordsPerRow();
+    int chunksY = (life.getSizeY() + kInstanceChunk - 1) / kInstanceChunk;
+    int chunksZ = (life.getSizeZ() + kInstanceChunk - 1) / kInstanceChunk;
+    size_t chunks = size_t(chunksX) * chunksY * chunksZ;
+    size_t slots = chunks * kSlotsPerChunk;
+
+    if (words != m_words || slots != m_slots) {
+        PROFILE_ZONE("GpuInstancer::resize");
+        allocateStorage(m_grid, words * 4, GL_STREAM_DRAW);
+        allocateStorage(m_offsets, slots * 4, GL_DYNAMIC_COPY);
+
+        // One level of block totals per factor of 256
+        size_t levels = 0;
+        for (size_t n = groupsFor(slots); ; n = groupsFor(n)) {
+            if (levels == m_sums.size()) {
+                m_sums.push_back(0);
+            }
+            allocateStorage(m_sums[levels++], n * 4, GL_DYNAMIC_COPY);
+            if (n <= 1) break;
+        }
+
+        // count, instanceCount, firstIndex, baseVertex, baseInstance per chunk
+        allocateStorage(m_commands, chunks * 5 * sizeof(GLuint), GL_DYNAMIC_DRAW);
+
+        m_words = words;
+        m_slots = slots;
+        m_chunksX = chunksX;
+        m_chunksY = chunksY;
+        m_chunksZ = chunksZ;
+    }
+
+    // Grows like InstanceBuffer; the population is known without touching cells
+    size_t population = life.getPopulation();
+    if (!m_instances || population > m_capacity ||
+        (population < m_capacity / 4 && m_capacity > InstanceBuffer::kMinCapacity)) {
+        size_t capacity = InstanceBuffer::kMinCapacity;
+        while (capacity < population) capacity *= 2;
+        allocateStorage(m_instances, capacity * sizeof(PackedInstance), GL_DYNAMIC_COPY);
+        m_capacity = capacity;
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void GpuInstancer::scan(size_t level, GLuint data, size_t count) {
+    size_t groups = groupsFor(count);
+    GLuint sums = m_sums[level];
+
+    m_scan.use();
+    m_scan.setUniform("count", int(count));
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, data);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, sums);
+    dispatch(groups);
+    if (groups <= 1) return;
+
+    // Offsets of the blocks themselves, then fold them in
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    scan(level + 1, sums, groups);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    m_add.use();
+    m_add.setUniform("count", int(count));
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, data);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, sums);
+    dispatch(groups);
+}
+
+void GpuInstancer::build(const LifeSnapshot& life, const Coloring& coloring, int bitsX, int bitsY) {
+    PROFILE_ZONE("GpuInstancer::build");
+    if (!m_ready) return;
+
+    const std::vector<uint64_t>& grid = life.getWords();
+    if (grid.empty()) return;
+    resize(life);
+
+    {
+        PROFILE_ZONE("GpuInstancer::upload");
+        // Orphan, then upload the words unchanged: little-endian uint64 is two uints
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_grid);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, GLsizeiptr(m_words * 4), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, GLsizeiptr(m_words * 4), grid.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    // Where each scanned slot lives in the grid
+    auto setLayout = [&](Shader& pass) {
+        pass.use();
+        pass.setUniform("count", int(m_slots));
+        pass.setUniform("chunksX", m_chunksX);
+        pass.setUniform("chunksY", m_chunksY);
+        pass.setUniform("sizeY", life.getSizeY());
+        pass.setUniform("sizeZ", life.getSizeZ());
+        pass.setUniform("wordsPerRow", life.getWordsPerRow());
+    };
+
+    size_t groups = groupsFor(m_slots);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_grid);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_offsets);
+
+    setLayout(m_count);
+    dispatch(groups);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    scan(0, m_offsets, m_slots);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    setLayout(m_emit);
+    m_emit.setUniform("sizeX", life.getSizeX());
+    m_emit.setUniform("toric", int(life.isToric()));
+    m_emit.setUniform("radius", coloring.getRadius());
+    m_emit.setUniform("byDepth", int(Coloring::shadesByDepth(coloring.getPattern())));
+    m_emit.setUniform("maxDensity", Coloring::kMaxDensity);
+    m_emit.setUniform("bitsX", bitsX);
+    m_emit.setUniform("bitsY", bitsY);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_grid);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_offsets);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, m_instances);
+    dispatch(groups);
+
+    // The chunk boundaries of the scan become the draw commands
+    setLayout(m_commandPass);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, m_commands);
+    dispatch(groupsFor(m_slots / kSlotsPerChunk));
+
+    // The draw reads the instances as vertex attributes and the commands indirectly
+    glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+}
@@ -1,29 +1,129 @@
 #include "InstanceBuffer.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstring>
 
-InstanceBuffer::InstanceBuffer(size_t maxInstances)
-    : m_maxInstances(maxInstances)
-{
-    glGenBuffers(1, &m_positionVBO);
-    glGenBuffers(1, &m_colorVBO);
+namespace {
+
+// Immutable storage mapped once for the buffer's lifetime
+void* createMappedBuffer(GLuint buffer, GLsizeiptr bytes) {
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferStorage(GL_ARRAY_BUFFER, bytes, nullptr, flags);
+    return glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, flags);
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, m_positionVBO);
-    glBufferData(GL_ARRAY_BUFFER, maxInstances * sizeof(glm::vec3), nullptr, GL_DYNAMIC_DRAW);
+} // namespace
 
-    glBindBuffer(GL_ARRAY_BUFFER, m_colorVBO);
-    glBufferData(GL_ARRAY_BUFFER, maxInstances * sizeof(glm::vec3), nullptr, GL_DYNAMIC_DRAW);
+InstanceBuffer::InstanceBuffer(size_t initialInstances)
+    : m_supportsStorage(GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage)
+{
+    allocate(capacityFor(initialInstances));
 }
 
 InstanceBuffer::~InstanceBuffer() {
-    if (m_positionVBO) glDeleteBuffers(1, &m_positionVBO);
-    if (m_colorVBO) glDeleteBuffers(1, &m_colorVBO);
+    release();
+}
+
+size_t InstanceBuffer::capacityFor(size_t count) const {
+    size_t capacity = kMinCapacity;
+    while (capacity < count) capacity *= 2;
+    return capacity;
+}
+
+void InstanceBuffer::release() {
+    for (GLsync& f : m_fences) {
+        if (f) glDeleteSync(f);
+        f = nullptr;
+    }
+    // Deleting a buffer also unmaps it; draws already queued keep their storage
+    if (m_VBO) glDeleteBuffers(1, &m_VBO);
+    m_VBO = 0;
+    m_map = nullptr;
+    m_persistent = false;
+}
+
+void InstanceBuffer::allocate(size_t capacity) {
+    PROFILE_ZONE("InstanceBuffer::allocate");
+    GLsizeiptr segmentBytes = GLsizeiptr(capacity * sizeof(PackedInstance));
+
+    if (m_supportsStorage) {
+        // Storage from glBufferStorage is immutable: resizing needs new buffers
+        release();
+        glGenBuffers(1, &m_VBO);
+        m_map = static_cast<PackedInstance*>(createMappedBuffer(m_VBO, segmentBytes * kSegments));
+        m_persistent = m_map != nullptr;
+        if (!m_persistent) {
+            release();
+            m_supportsStorage = false;
+        }
+    }
+
+    if (!m_persistent) {
+        if (!m_VBO) glGenBuffers(1, &m_VBO);
+        // Respecifying the store orphans the old one, same as before each upload
+        glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+        glBufferData(GL_ARRAY_BUFFER, segmentBytes, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (m_capacity) ++m_resizes;
+    m_capacity = capacity;
+    m_segment = 0;
+    m_offset = 0;
+    m_lowUploads = 0;
+}
+
+void InstanceBuffer::waitForSegment(int segment) {
+    GLsync& f = m_fences[segment];
+    if (!f) return;
+
+    PROFILE_ZONE("InstanceBuffer::wait");
+    for (;;) {
+        GLenum result = glClientWaitSync(f, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000); // 1 s
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED)
+            break;
+    }
+    glDeleteSync(f);
+    f = nullptr;
 }
 
-void InstanceBuffer::uploadPositions(const std::vector<glm::vec3>& positions) {
-    glBindBuffer(GL_ARRAY_BUFFER, m_positionVBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, positions.size() * sizeof(glm::vec3), positions.data());
+size_t InstanceBuffer::upload(const std::vector<PackedInstance>& instances) {
+    size_t count = instances.size();
+    size_t bytes = count * sizeof(PackedInstance);
+
+    if (count > m_capacity) {
+        allocate(capacityFor(count));
+    } else if (count < m_capacity / 4 && m_capacity > kMinCapacity) {
+        if (++m_lowUploads >= kShrinkAfter)
+            allocate(std::max(capacityFor(count), m_capacity / 2));
+    } else {
+        m_lowUploads = 0;
+    }
+
+    if (m_persistent) {
+        // The segment written three uploads ago may still be read by a queued draw
+        m_segment = (m_segment + 1) % kSegments;
+        waitForSegment(m_segment);
+
+        size_t first = size_t(m_segment) * m_capacity;
+        std::memcpy(m_map + first, instances.data(), bytes);
+        m_offset = GLintptr(first * sizeof(PackedInstance));
+        return count;
+    }
+
+    // Orphaning: the driver hands out fresh storage while queued draws keep the old
+    GLsizeiptr capacityBytes = GLsizeiptr(m_capacity * sizeof(PackedInstance));
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferData(GL_ARRAY_BUFFER, capacityBytes, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, GLsizeiptr(bytes), instances.data());
+    m_offset = 0;
+    return count;
 }
 
-void InstanceBuffer::uploadColors(const std::vector<glm::vec3>& colors) {
-    glBindBuffer(GL_ARRAY_BUFFER, m_colorVBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, colors.size() * sizeof(glm::vec3), colors.data());
+void InstanceBuffer::fence() {
+    if (!m_persistent) return;
+    GLsync& f = m_fences[m_segment];
+    if (f) glDeleteSync(f);
+    f = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 }
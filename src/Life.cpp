@@ -2,70 +2,801 @@
 #include <filesystem>
 #include <random>
 #include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <thread>
+#include <cstdlib>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 #include "Life.h"
+#include "LifeSnapshot.h"
+#include "Profiler.h"
+#include "MappedFile.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 
+namespace {
+
+// Adaptive engine policy
+const int kMinBitslicedWidth = 16;   // narrower rows leave most of each word idle
+const float kEnterSparse = 0.01f;    // changed-word fraction below which Sparse wins
+const float kLeaveSparse = 0.04f;    // ... and above which it stops winning
+const float kEnterSparseDensity = 0.25f; // live fraction above which Sparse is not entered
+const float kLeaveSparseDensity = 0.35f; // ... and above which it is left
+const size_t kMinSparseWords = 256;  // smaller grids cost less to sweep than to track
+const int kSwitchStreak = 8;         // generations a condition must hold before switching
+const size_t kMaxHistory = 256;
+
+int popcount64(uint64_t v) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(v);
+#else
+    int n = 0;
+    for (; v; v &= v - 1) ++n;
+    return n;
+#endif
+}
+
+// Totals are counted including the cell itself, so a live cell with n
+// neighbors survives when the total is n + 1.
+struct Rule {
+    uint32_t birth;    // bit n: a dead cell with n neighbors is born
+    uint32_t survive;  // bit n: a live cell with n neighbors survives
+    bool planar;       // neighbors only within the XY plane
+    int born[27], bornCount = 0;
+    int kept[27], keptCount = 0;
+};
+
+Rule ruleFor(LifeMode mode) {
+    Rule rule{};
+    switch (mode) {
+        case LifeMode::Current3D: rule.birth = 1u << 5; rule.survive = (1u << 5) | (1u << 6); break;
+        case LifeMode::Conway2D:  rule.birth = 1u << 3; rule.survive = (1u << 2) | (1u << 3); rule.planar = true; break;
+        case LifeMode::Custom3D:  rule.birth = 1u << 5; rule.survive = (1u << 4) | (1u << 5) | (1u << 6); break;
+        case LifeMode::Custom2D:  rule.birth = (1u << 3) | (1u << 6); rule.survive = (1u << 2) | (1u << 4); rule.planar = true; break;
+    }
+    for (int n = 0; n < 27; ++n) {
+        if ((rule.birth >> n) & 1) rule.born[rule.bornCount++] = n;
+        if ((rule.survive >> n) & 1) rule.kept[rule.keptCount++] = n + 1;
+    }
+    return rule;
+}
+
+struct RowShape {
+    int lastWord;       // index of the last word of a row
+    int lastBit;        // bit of cell sizeX-1 inside the last word
+    uint64_t lastMask;  // valid bits of the last word
+    bool toric;
+};
+
+// Adds the one-bit-per-lane value v at weight 2^bit to a 5-bit lane counter
+inline void addAt(uint64_t sum[5], int bit, uint64_t v) {
+    for (; v && bit < 5; ++bit) {
+        uint64_t carry = sum[bit] & v;
+        sum[bit] ^= v;
+        v = carry;
+    }
+}
+
+inline uint64_t lanesEqual(const uint64_t sum[5], int n) {
+    uint64_t m = ~0ULL;
+    for (int i = 0; i < 5; ++i)
+        m &= ((n >> i) & 1) ? sum[i] : ~sum[i];
+    return m;
+}
+
+// Next state of the 64 cells in word w of a row, given its neighbor rows
+// (the row itself included)
+uint64_t stepWord(const uint64_t* const* rows, int rowCount, int w,
+                  const RowShape& shape, const Rule& rule, uint64_t self) {
+    uint64_t sum[5] = { 0, 0, 0, 0, 0 };
+
+    for (int r = 0; r < rowCount; ++r) {
+        const uint64_t* row = rows[r];
+        uint64_t c = row[w];
+        uint64_t left = c << 1;   // lane x holds cell x-1
+        uint64_t right = c >> 1;  // lane x holds cell x+1
+
+        if (w > 0) left |= row[w - 1] >> 63;
+        else if (shape.toric) left |= (row[shape.lastWord] >> shape.lastBit) & 1;
+
+        if (w < shape.lastWord) right |= row[w + 1] << 63;
+        else if (shape.toric) right |= (row[0] & 1) << shape.lastBit;
+
+        // Full adder: left + c + right as a 2-bit lane value
+        uint64_t half = left ^ c;
+        addAt(sum, 0, half ^ right);
+        addAt(sum, 1, (left & c) | (half & right));
+    }
+
+    uint64_t born = 0, kept = 0;
+    for (int i = 0; i < rule.bornCount; ++i) born |= lanesEqual(sum, rule.born[i]);
+    for (int i = 0; i < rule.keptCount; ++i) kept |= lanesEqual(sum, rule.kept[i]);
+
+    uint64_t out = (~self & born) | (self & kept);
+    return w == shape.lastWord ? out & shape.lastMask : out;
+}
+
+// Hands out [begin, end) row ranges of slabRows rows to up to `threads`
+// workers of the pool
+template <typename Fn>
+void forEachSlab(WorkerPool& pool, int rowCount, int slabRows, int threads, Fn fn) {
+    int slabs = (rowCount + slabRows - 1) / slabRows;
+    int workers = std::min(threads, slabs);
+    if (workers <= 1) {
+        fn(0, rowCount);
+        return;
+    }
+
+    std::atomic<int> nextRow{0};
+    pool.run(workers, [&]() {
+        for (;;) {
+            int begin = nextRow.fetch_add(slabRows);
+            if (begin >= rowCount) break;
+            fn(begin, std::min(begin + slabRows, rowCount));
+        }
+    });
+}
+
+// Binary snapshot layout (all fields little-endian):
+//   0  "LIFB"          4  version u16      6  header size u16
+//   8  sizeX u32      12  sizeY u32       16  sizeZ u32
+//  20  wordsPerRow u32 24 mode u8         25  toric u8
+//  32  generation i64 40  population u64  48  FNV-1a of the payload u64
+//  64  packed words, u64 each, rows padded to whole words
+const char kBinaryMagic[4] = { 'L', 'I', 'F', 'B' };
+const uint16_t kBinaryVersion = 1;
+const size_t kBinaryHeaderSize = 64;
+
+void putLE(unsigned char* out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) out[i] = (unsigned char)(value >> (8 * i));
+}
+
+uint64_t getLE(const unsigned char* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) value |= uint64_t(in[i]) << (8 * i);
+    return value;
+}
+
+bool hostIsLittleEndian() {
+    const uint16_t probe = 1;
+    return *reinterpret_cast<const unsigned char*>(&probe) == 1;
+}
+
+uint64_t checksumWords(const std::vector<uint64_t>& words) {
+    uint64_t hash = 1469598103934665603ull;
+    for (uint64_t w : words)
+        for (int i = 0; i < 8; ++i) {
+            hash ^= (w >> (8 * i)) & 0xFF;
+            hash *= 1099511628211ull;
+        }
+    return hash;
+}
+
+// Text loader helpers: lines are split on '\n' only, like std::getline
+bool nextLine(const char*& at, const char* end, std::string& line) {
+    if (at >= end) return false;
+    const char* lineEnd = static_cast<const char*>(std::memchr(at, '\n', end - at));
+    if (!lineEnd) lineEnd = end;
+    line.assign(at, lineEnd);
+    at = lineEnd < end ? lineEnd + 1 : end;
+    return true;
+}
+
+// Bit i set where byte i of chunk equals the byte repeated in pattern
+// (little-endian loads: byte i is character i)
+uint64_t matchBits8(uint64_t chunk, uint64_t pattern) {
+    const uint64_t low7 = 0x7F7F7F7F7F7F7F7Full;
+    uint64_t t = chunk ^ pattern;
+    uint64_t zero = ~(((t & low7) + low7) | t | low7); // high bit of each zero byte
+    return ((zero >> 7) * 0x0102040810204080ull) >> 56;
+}
+
+int trailingZeros64(uint64_t v) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(v);
+#else
+    int n = 0;
+    for (; !(v & 1); v >>= 1) ++n;
+    return n;
+#endif
+}
+
+// RLE rules for each mode, birth and survival by neighbor count
+struct RleRule {
+    LifeMode mode;
+    const char* text;
+};
+
+const RleRule kRleRules[] = {
+    { LifeMode::Current3D, "B5/S56" },
+    { LifeMode::Conway2D,  "B3/S23" },
+    { LifeMode::Custom3D,  "B5/S456" },
+    { LifeMode::Custom2D,  "B36/S24" },
+};
+
+const char* rleRuleFor(LifeMode mode) {
+    for (const RleRule& rule : kRleRules)
+        if (rule.mode == mode) return rule.text;
+    return "B3/S23";
+}
+
+// "B3/S23", "S23/B3" or the older survival-first "23/3", any case, with an
+// optional Golly topology suffix (":T100,100" is a torus, ":P..." a plane)
+bool parseRleRule(const std::string& text, uint32_t& birth, uint32_t& survive, bool& toric) {
+    size_t colon = text.find(':');
+    toric = colon != std::string::npos && colon + 1 < text.size() &&
+            std::toupper((unsigned char)text[colon + 1]) == 'T';
+    std::string rule = text.substr(0, colon);
+
+    size_t slash = rule.find('/');
+    if (slash == std::string::npos) return false;
+    std::string parts[2] = { rule.substr(0, slash), rule.substr(slash + 1) };
+
+    birth = survive = 0;
+    for (int i = 0; i < 2; ++i) {
+        const std::string& part = parts[i];
+        uint32_t* target = i == 0 ? &survive : &birth; // "23/3" order
+        size_t start = 0;
+        if (!part.empty() && std::isalpha((unsigned char)part[0])) {
+            char tag = char(std::toupper((unsigned char)part[0]));
+            if (tag != 'B' && tag != 'S') return false;
+            target = tag == 'B' ? &birth : &survive;
+            start = 1;
+        }
+        for (size_t c = start; c < part.size(); ++c) {
+            if (!std::isdigit((unsigned char)part[c])) return false;
+            *target |= 1u << (part[c] - '0');
+        }
+    }
+    return true;
+}
+
+bool rleModeFor(const std::string& text, LifeMode& mode, bool& toric) {
+    uint32_t birth, survive;
+    if (!parseRleRule(text, birth, survive, toric)) return false;
+    for (const RleRule& known : kRleRules) {
+        uint32_t b, s;
+        bool t;
+        parseRleRule(known.text, b, s, t);
+        if (b == birth && s == survive) {
+            mode = known.mode;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Sets cells [x, x + count) of a packed row, a word at a time
+void fillRun(uint64_t* row, int x, int count) {
+    int end = x + count;
+    while (x < end) {
+        int bit = x & 63;
+        int n = std::min(64 - bit, end - x);
+        uint64_t mask = n == 64 ? ~0ULL : ((1ULL << n) - 1) << bit;
+        row[x >> 6] |= mask;
+        x += n;
+    }
+}
+
+// First cell at or after x whose state is value, or sizeX if there is none.
+// Padding bits are always clear, so searching for dead cells stops there.
+int findCell(const uint64_t* row, int words, int sizeX, int x, bool value) {
+    int w = x >> 6;
+    if (w >= words) return sizeX;
+    uint64_t bits = (value ? row[w] : ~row[w]) & (~0ULL << (x & 63));
+    while (!bits) {
+        if (++w >= words) return sizeX;
+        bits = value ? row[w] : ~row[w];
+    }
+    return std::min(sizeX, (w << 6) + trailingZeros64(bits));
+}
+
+// Writes "<count><tag>" tokens, wrapping lines at Golly's 70 characters
+class RleLineWriter {
+public:
+    explicit RleLineWriter(std::ostream& out) : m_out(out) {}
+
+    void put(long long count, char tag) {
+        if (count <= 0) return;
+        char token[24];
+        int length = count == 1 ? std::snprintf(token, sizeof(token), "%c", tag)
+                                : std::snprintf(token, sizeof(token), "%lld%c", count, tag);
+        if (m_line.size() + length > 70) {
+            m_out << m_line << "\n";
+            m_line.clear();
+        }
+        m_line.append(token, length);
+    }
+
+    void finish() {
+        put(1, '!');
+        m_out << m_line << "\n";
+        m_line.clear();
+    }
+
+private:
+    std::ostream& m_out;
+    std::string m_line;
+};
+
+} // namespace
+
 Life::Life(int sizeX, int sizeY, int sizeZ)
-    : m_sizeX(sizeX), m_sizeY(sizeY), m_sizeZ(sizeZ)
+    : m_sizeX(sizeX), m_sizeY(sizeY), m_sizeZ(sizeZ), m_random(std::random_device{}())
 {
-    m_grid.resize(m_sizeX * m_sizeY * m_sizeZ, false);
-    m_next.resize(m_sizeX * m_sizeY * m_sizeZ, false);
+    allocate(sizeX, sizeY, sizeZ);
+    setEngine(LifeEngine::Auto);
+}
+
+void Life::allocate(int sizeX, int sizeY, int sizeZ) {
+    m_sizeX = sizeX;
+    m_sizeY = sizeY;
+    m_sizeZ = sizeZ;
+    m_wordsPerRow = (m_sizeX + 63) / 64;
+
+    size_t words = size_t(m_wordsPerRow) * m_sizeY * m_sizeZ;
+    m_grid.assign(words, 0);
+    m_next.assign(words, 0);
+    m_activeMark.assign(words, 0);
+    m_changedWords.clear();
+    m_sparseValid = false;
+
+    m_generation = 0;
+    m_population = 0;
+    m_populationValid = true;
+    ++m_revision;
+    m_changedCells = 0;
+    m_changedWordCount = 0;
+
+    m_engineHistory.clear();
+    m_policyStreak = 0;
+    if (m_engine == LifeEngine::Auto)
+        m_activeEngine = fullEngine();
 }
 
 void Life::randomize() {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> dis(0.0, 1.0);
+    randomize(0.3f, m_random());
+}
+
+std::string Life::getRandomState() const {
+    std::ostringstream out;
+    out << m_random;
+    return out.str();
+}
+
+bool Life::setRandomState(const std::string& state) {
+    std::istringstream in(state);
+    std::mt19937_64 random;
+    if (!(in >> random)) return false;
+    m_random = random;
+    return true;
+}
+
+// Builds each word from 16 random words, one per bit of the density
+// (from the least significant): OR for a 1 bit, AND for a 0 bit. Each lane
+// then ends up set with probability density, to 1/65536.
+void Life::randomize(float density, uint64_t seed) {
+    std::mt19937_64 gen(seed);
+    uint32_t threshold = uint32_t(std::clamp(density, 0.0f, 1.0f) * 65536.0f + 0.5f);
+    uint64_t lastMask = ~0ULL >> (63 - ((m_sizeX - 1) & 63));
 
-    for (size_t i = 0; i < m_grid.size(); ++i)
-        m_grid[i] = (dis(gen) > 0.7f);
+    for (size_t i = 0; i < m_grid.size(); ++i) {
+        uint64_t word = 0;
+        if (threshold >= 65536) {
+            word = ~0ULL;
+        } else {
+            for (int bit = 0; bit < 16; ++bit)
+                word = ((threshold >> bit) & 1) ? (word | gen()) : (word & gen());
+        }
+        if (int(i % m_wordsPerRow) == m_wordsPerRow - 1) word &= lastMask;
+        m_grid[i] = word;
+    }
+
+    m_populationValid = false;
+    ++m_revision;
+    m_sparseValid = false;
 }
 
 void Life::update() {
-    if (m_mode == LifeMode::Current3D) {
-        for (int z = 0; z < m_sizeZ; ++z)
-            for (int y = 0; y < m_sizeY; ++y)
-                for (int x = 0; x < m_sizeX; ++x) {
-                    int neighbors = countNeighbors(x, y, z);
-                    bool currentState = getCell(x, y, z);
-                    m_next[getIndex(x, y, z)] = currentState ? (neighbors == 5 || neighbors == 6) : (neighbors == 5);
+    PROFILE_ZONE("Life::update");
+
+    switch (m_activeEngine) {
+        case LifeEngine::Dense:
+            updateDense();
+            collectChanges();
+            break;
+        case LifeEngine::Sparse:
+            updateSparse();
+            break;
+        default:
+            updateBitsliced();
+            collectChanges();
+            break;
+    }
+
+    std::swap(m_grid, m_next);
+    ++m_generation;
+    ++m_revision;
+
+    if (m_engine == LifeEngine::Auto)
+        chooseEngine();
+}
+
+void Life::updateDense() {
+    PROFILE_ZONE("Life::updateDense");
+    Rule rule = ruleFor(m_mode);
+
+    forEachSlab(m_pool, m_sizeY * m_sizeZ, m_slabRows, m_threads, [&](int begin, int end) {
+        const uint64_t* rows[9];
+        std::vector<uint8_t> column(m_sizeX);
+
+        for (int row = begin; row < end; ++row) {
+            int n = gatherRows(row % m_sizeY, row / m_sizeY, rows);
+            size_t base = size_t(row) * m_wordsPerRow;
+
+            // Live cells per x over the neighbor rows
+            for (int x = 0; x < m_sizeX; ++x) {
+                int count = 0;
+                for (int r = 0; r < n; ++r)
+                    count += (rows[r][x >> 6] >> (x & 63)) & 1;
+                column[x] = uint8_t(count);
+            }
+
+            uint64_t* out = &m_next[base];
+            std::fill(out, out + m_wordsPerRow, 0);
+
+            for (int x = 0; x < m_sizeX; ++x) {
+                int total = column[x];
+                if (x > 0) total += column[x - 1];
+                else if (m_toric) total += column[m_sizeX - 1];
+                if (x < m_sizeX - 1) total += column[x + 1];
+                else if (m_toric) total += column[0];
+
+                bool alive = (m_grid[base + (x >> 6)] >> (x & 63)) & 1;
+                bool next = alive ? (rule.survive >> (total - 1)) & 1 : (rule.birth >> total) & 1;
+                if (next) out[x >> 6] |= 1ULL << (x & 63);
+            }
+        }
+    });
+}
+
+void Life::updateBitsliced() {
+    PROFILE_ZONE("Life::updateBitsliced");
+    Rule rule = ruleFor(m_mode);
+    RowShape shape = { m_wordsPerRow - 1, (m_sizeX - 1) & 63,
+                       ~0ULL >> (63 - ((m_sizeX - 1) & 63)), m_toric };
+
+    forEachSlab(m_pool, m_sizeY * m_sizeZ, m_slabRows, m_threads, [&](int begin, int end) {
+        const uint64_t* rows[9];
+        for (int row = begin; row < end; ++row) {
+            int n = gatherRows(row % m_sizeY, row / m_sizeY, rows);
+            size_t base = size_t(row) * m_wordsPerRow;
+            for (int w = 0; w < m_wordsPerRow; ++w)
+                m_next[base + w] = stepWord(rows, n, w, shape, rule, m_grid[base + w]);
+        }
+    });
+}
+
+void Life::updateSparse() {
+    PROFILE_ZONE("Life::updateSparse");
+    if (!m_sparseValid) {
+        // No record of what changed last: one full pass rebuilds it
+        updateBitsliced();
+        collectChanges();
+        return;
+    }
+
+    Rule rule = ruleFor(m_mode);
+    RowShape shape = { m_wordsPerRow - 1, (m_sizeX - 1) & 63,
+                       ~0ULL >> (63 - ((m_sizeX - 1) & 63)), m_toric };
+    size_t population = getPopulation();
+
+    // m_next still holds the generation before m_grid and differs from it
+    // only in m_changedWords (edits included). Every such word is in its own
+    // neighborhood, so the active pass below rewrites all of them and the
+    // rest of m_next is already current: no full copy is needed.
+
+    // Words whose neighborhood touches a changed word
+    std::vector<size_t> active;
+    int dzMin = rule.planar ? 0 : -1, dzMax = rule.planar ? 0 : 1;
+    for (size_t index : m_changedWords) {
+        int row = int(index / m_wordsPerRow);
+        int w = int(index % m_wordsPerRow);
+        int y = row % m_sizeY, z = row / m_sizeY;
+
+        for (int dz = dzMin; dz <= dzMax; ++dz)
+            for (int dy = -1; dy <= 1; ++dy) {
+                int ny = y + dy, nz = z + dz;
+                if (m_toric) {
+                    ny = (ny + m_sizeY) % m_sizeY;
+                    nz = (nz + m_sizeZ) % m_sizeZ;
+                } else if (ny < 0 || ny >= m_sizeY || nz < 0 || nz >= m_sizeZ) {
+                    continue;
                 }
-    } 
-    else if (m_mode == LifeMode::Conway2D) {
-        for (int z = 0; z < m_sizeZ; ++z)
-            for (int y = 0; y < m_sizeY; ++y)
-                for (int x = 0; x < m_sizeX; ++x) {
-                    int neighbors = countNeighbors2D(x, y, z);
-                    bool currentState = getCell(x, y, z);
-                    m_next[getIndex(x, y, z)] = currentState ? (neighbors == 2 || neighbors == 3) : (neighbors == 3);
+
+                for (int dw = -1; dw <= 1; ++dw) {
+                    int nw = w + dw;
+                    if (nw < 0 || nw >= m_wordsPerRow) {
+                        if (!m_toric) continue;
+                        nw = (nw + m_wordsPerRow) % m_wordsPerRow;
+                    }
+                    size_t target = (size_t(nz) * m_sizeY + ny) * m_wordsPerRow + nw;
+                    if (!m_activeMark[target]) {
+                        m_activeMark[target] = 1;
+                        active.push_back(target);
+                    }
                 }
+            }
     }
-    else if (m_mode == LifeMode::Custom3D) {
-        for (int z = 0; z < m_sizeZ; ++z)
-            for (int y = 0; y < m_sizeY; ++y)
-                for (int x = 0; x < m_sizeX; ++x) {
-                    int neighbors = countNeighbors(x, y, z);
-                    bool currentState = getCell(x, y, z);
-                    m_next[getIndex(x, y, z)] = currentState ? (neighbors >= 4 && neighbors <= 6) : (neighbors == 5);
-                }
+
+    std::vector<size_t> changed;
+    size_t changedCells = 0;
+    const uint64_t* rows[9];
+    for (size_t index : active) {
+        m_activeMark[index] = 0;
+
+        int row = int(index / m_wordsPerRow);
+        int w = int(index % m_wordsPerRow);
+        int n = gatherRows(row % m_sizeY, row / m_sizeY, rows);
+
+        uint64_t before = m_grid[index];
+        uint64_t after = stepWord(rows, n, w, shape, rule, before);
+        m_next[index] = after;
+
+        if (before != after) {
+            changed.push_back(index);
+            changedCells += popcount64(before ^ after);
+            population += popcount64(after);
+            population -= popcount64(before);
+        }
     }
-    else if (m_mode == LifeMode::Custom2D) {
-        for (int z = 0; z < m_sizeZ; ++z)
-            for (int y = 0; y < m_sizeY; ++y)
-                for (int x = 0; x < m_sizeX; ++x) {
-                    int neighbors = countNeighbors2D(x, y, z);
-                    bool currentState = getCell(x, y, z);
-                    m_next[getIndex(x, y, z)] = currentState ? (neighbors == 2 || neighbors == 4) : (neighbors == 3 || neighbors == 6);
-                }
+
+    m_changedWords.swap(changed);
+    m_changedCells = changedCells;
+    m_changedWordCount = m_changedWords.size();
+    m_population = population;
+    m_populationValid = true;
+}
+
+// Population and change statistics after a full pass, plus the changed-word
+// list the Sparse engine continues from
+void Life::collectChanges() {
+    PROFILE_ZONE("Life::collectChanges");
+    size_t cap = m_next.size() / 8 + 1; // past this Sparse cannot win anyway
+    size_t population = 0, changedCells = 0, changedWords = 0;
+
+    m_changedWords.clear();
+    m_sparseValid = true;
+
+    for (size_t i = 0; i < m_next.size(); ++i) {
+        population += popcount64(m_next[i]);
+        uint64_t diff = m_next[i] ^ m_grid[i];
+        if (!diff) continue;
+
+        changedCells += popcount64(diff);
+        ++changedWords;
+        if (m_sparseValid) {
+            if (m_changedWords.size() < cap) {
+                m_changedWords.push_back(i);
+            } else {
+                m_sparseValid = false;
+                m_changedWords.clear();
+            }
+        }
     }
 
-    std::swap(m_grid, m_next);
+    m_population = population;
+    m_populationValid = true;
+    m_changedCells = changedCells;
+    m_changedWordCount = changedWords;
+}
+
+// Hysteresis policy: Sparse is entered when few words change and the grid
+// is thinly populated, and left when many words change or it fills up, each
+// only after the condition held for kSwitchStreak generations. A crowded
+// grid can flare up across most of its words in one generation, and each
+// changed word costs Sparse a whole neighborhood of work. Grids below
+// kMinSparseWords always use a full kernel.
+void Life::chooseEngine() {
+    size_t cells = size_t(m_sizeX) * m_sizeY * m_sizeZ;
+    if (cells == 0) return;
+
+    float density = float(getPopulation()) / float(cells);
+    float activity = float(m_changedWordCount) / float(m_grid.size());
+
+    LifeEngine full = fullEngine();
+    LifeEngine target = full;
+    if (m_grid.size() < kMinSparseWords)
+        target = full;
+    else if (m_activeEngine == LifeEngine::Sparse)
+        target = activity > kLeaveSparse || density > kLeaveSparseDensity ? full : LifeEngine::Sparse;
+    else if (activity < kEnterSparse && density < kEnterSparseDensity)
+        target = LifeEngine::Sparse;
+
+    if (target == m_activeEngine) {
+        m_policyStreak = 0;
+        return;
+    }
+
+    // An empty world or a switch between full kernels needs no confirmation
+    bool immediate = m_population == 0 ||
+                     (target != LifeEngine::Sparse && m_activeEngine != LifeEngine::Sparse);
+    if (!immediate && ++m_policyStreak < kSwitchStreak)
+        return;
+
+    if (m_engineHistory.size() >= kMaxHistory)
+        m_engineHistory.erase(m_engineHistory.begin());
+    m_engineHistory.push_back({ m_generation, m_activeEngine, target, density, activity });
+
+    m_activeEngine = target;
+    m_policyStreak = 0;
+}
+
+void Life::setEngine(LifeEngine engine) {
+    m_engine = engine;
+    m_activeEngine = engine == LifeEngine::Auto ? fullEngine() : engine;
+    m_policyStreak = 0;
+}
+
+void Life::snapshot(LifeSnapshot& out) const {
+    PROFILE_ZONE("Life::snapshot");
+    out.m_sizeX = m_sizeX;
+    out.m_sizeY = m_sizeY;
+    out.m_sizeZ = m_sizeZ;
+    out.m_wordsPerRow = m_wordsPerRow;
+    out.m_mode = m_mode;
+    out.m_toric = m_toric;
+    out.m_generation = m_generation;
+    out.m_revision = m_revision;
+    out.m_population = getPopulation();
+    out.m_words.assign(m_grid.begin(), m_grid.end());
+}
+
+// The kernel Auto uses while the grid is busy: the tuned one if a profile
+// chose it, otherwise Dense for rows too narrow to fill a word
+LifeEngine Life::fullEngine() const {
+    if (m_tunedKernel == LifeEngine::Dense || m_tunedKernel == LifeEngine::Bitsliced)
+        return m_tunedKernel;
+    return m_sizeX < kMinBitslicedWidth ? LifeEngine::Dense : LifeEngine::Bitsliced;
+}
+
+void Life::setTunedKernel(LifeEngine kernel) {
+    m_tunedKernel = kernel;
+    if (m_engine == LifeEngine::Auto && m_activeEngine != LifeEngine::Sparse)
+        m_activeEngine = fullEngine();
+}
+
+bool Life::loadProfile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open())
+        return false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) continue;
+        std::string key = line.substr(0, eq);
+        std::string value = line.substr(eq + 1);
+
+        LifeEngine kernel;
+        if (key == "kernel" && parseEngine(value, kernel)) setTunedKernel(kernel);
+        else if (key == "threads") setThreadCount(std::atoi(value.c_str()));
+        else if (key == "slabRows") setSlabRows(std::atoi(value.c_str()));
+    }
+
+    std::cout << "Loaded tuning profile " << path << ": " << engineName(fullEngine())
+              << ", " << m_threads << " thread(s), " << m_slabRows << " rows per slab" << std::endl;
+    return true;
+}
+
+std::string Life::machineProfilePath() {
+    std::string host;
+#ifdef _WIN32
+    if (const char* name = std::getenv("COMPUTERNAME")) host = name;
+#else
+    char name[256] = {};
+    if (gethostname(name, sizeof(name) - 1) == 0) host = name;
+#endif
+    if (host.empty()) host = "default";
+    return "profiles/" + host + ".profile";
+}
+
+void Life::setThreadCount(int threads) {
+    m_threads = std::max(1, threads);
+}
+
+void Life::setSlabRows(int rows) {
+    m_slabRows = std::max(1, rows);
+}
+
+size_t Life::getPopulation() const {
+    if (!m_populationValid) {
+        m_population = 0;
+        for (uint64_t word : m_grid)
+            m_population += popcount64(word);
+        m_populationValid = true;
+    }
+    return m_population;
+}
+
+// Names match the GUI buttons and terminal commands
+const char* Life::modeName(LifeMode mode) {
+    switch (mode) {
+        case LifeMode::Current3D: return "Conway3D";
+        case LifeMode::Conway2D:  return "Conway2D";
+        case LifeMode::Custom3D:  return "Custom3D";
+        case LifeMode::Custom2D:  return "Custom2D";
+    }
+    return "unknown";
+}
+
+bool Life::parseDims(const std::string& text, int& x, int& y, int& z) {
+    size_t p1 = text.find('x');
+    size_t p2 = text.rfind('x');
+    if (p1 == std::string::npos || p1 == p2) return false;
+
+    const char* s = text.c_str();
+    char* stop;
+    long values[3];
+    size_t starts[3] = { 0, p1 + 1, p2 + 1 };
+    for (int i = 0; i < 3; ++i) {
+        values[i] = std::strtol(s + starts[i], &stop, 10);
+        if (stop == s + starts[i] || values[i] <= 0 || values[i] > (1L << 24)) return false;
+    }
+    x = int(values[0]);
+    y = int(values[1]);
+    z = int(values[2]);
+    return true;
+}
+
+bool Life::parseMode(const std::string& name, LifeMode& mode) {
+    for (LifeMode m : { LifeMode::Current3D, LifeMode::Conway2D, LifeMode::Custom3D, LifeMode::Custom2D }) {
+        if (name == modeName(m)) {
+            mode = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* Life::engineName(LifeEngine engine) {
+    switch (engine) {
+        case LifeEngine::Dense:     return "dense";
+        case LifeEngine::Bitsliced: return "bitsliced";
+        case LifeEngine::Sparse:    return "sparse";
+        case LifeEngine::Auto:      return "auto";
+    }
+    return "unknown";
+}
+
+bool Life::parseEngine(const std::string& name, LifeEngine& engine) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return char(std::tolower(c)); });
+
+    for (LifeEngine e : { LifeEngine::Dense, LifeEngine::Bitsliced, LifeEngine::Sparse, LifeEngine::Auto }) {
+        if (lower == engineName(e)) {
+            engine = e;
+            return true;
+        }
+    }
+    return false;
 }
 
 void Life::clear() {
-    std::fill(m_grid.begin(), m_grid.end(), false);
+    std::fill(m_grid.begin(), m_grid.end(), 0);
+    m_population = 0;
+    m_populationValid = true;
+    ++m_revision;
+    m_sparseValid = false;
 }
 
 bool Life::getCell(int x, int y, int z) const {
@@ -73,14 +804,62 @@ bool Life::getCell(int x, int y, int z) const {
         x = (x + m_sizeX) % m_sizeX;
         y = (y + m_sizeY) % m_sizeY;
         z = (z + m_sizeZ) % m_sizeZ;
-        return m_grid[getIndex(x, y, z)];
+    } else if (!isValidPosition(x, y, z)) {
+        return false;
     }
-    return isValidPosition(x, y, z) ? m_grid[getIndex(x, y, z)] : false;
+    return (m_grid[wordIndex(x, y, z)] >> (x & 63)) & 1;
 }
 
 void Life::setCell(int x, int y, int z, bool state) {
-    if (isValidPosition(x, y, z))
-        m_grid[getIndex(x, y, z)] = state;
+    if (!isValidPosition(x, y, z)) return;
+
+    size_t index = wordIndex(x, y, z);
+    uint64_t bit = 1ULL << (x & 63);
+    if (((m_grid[index] & bit) != 0) == state) return;
+
+    m_grid[index] ^= bit;
+    ++m_revision;
+    if (m_populationValid) {
+        if (state) ++m_population;
+        else --m_population;
+    }
+
+    // The edit is one more change for the Sparse engine to look around
+    if (m_sparseValid) {
+        if (m_changedWords.size() < m_grid.size() / 8 + 1) m_changedWords.push_back(index);
+        else m_sparseValid = false;
+    }
+}
+
+bool Life::restore(int sizeX, int sizeY, int sizeZ, std::vector<uint64_t> words, long long generation) {
+    int wordsPerRow = (sizeX + 63) / 64;
+    if (sizeX <= 0 || sizeY <= 0 || sizeZ <= 0 || words.size() != size_t(wordsPerRow) * sizeY * sizeZ) {
+        std::cerr << "Cannot restore a " << words.size() << "-word grid as "
+                  << sizeX << "x" << sizeY << "x" << sizeZ << std::endl;
+        return false;
+    }
+
+    // Bits past sizeX in each row's last word must stay clear for the kernels
+    if (sizeX % 64 != 0) {
+        uint64_t mask = (uint64_t(1) << (sizeX % 64)) - 1;
+        for (size_t i = wordsPerRow - 1; i < words.size(); i += wordsPerRow)
+            words[i] &= mask;
+    }
+
+    allocate(sizeX, sizeY, sizeZ);
+    m_grid.swap(words);
+    m_generation = generation;
+    m_populationValid = false;
+    return true;
+}
+
+void Life::setCells(const std::vector<CellEdit>& edits) {
+    // Past this many edits a full pass is cheaper than tracking each word
+    if (edits.size() > m_grid.size() / 8)
+        m_sparseValid = false;
+
+    for (const CellEdit& edit : edits)
+        setCell(edit.x, edit.y, edit.z, edit.alive);
 }
 
 float Life::computeDensity(int x, int y, int z, int radius) const {
@@ -106,144 +885,467 @@ bool Life::isValidPosition(int x, int y, int z) const {
            z >= 0 && z < m_sizeZ;
 }
 
-int Life::countNeighbors(int x, int y, int z) const {
-    int count = 0;
-    for (int dz = -1; dz <= 1; ++dz)
-        for (int dy = -1; dy <= 1; ++dy)
-            for (int dx = -1; dx <= 1; ++dx) {
-                if (dx == 0 && dy == 0 && dz == 0) continue;
-                int nx = x + dx, ny = y + dy, nz = z + dz;
-
-                if (m_toric) {
-                    nx = (nx + m_sizeX) % m_sizeX;
-                    ny = (ny + m_sizeY) % m_sizeY;
-                    nz = (nz + m_sizeZ) % m_sizeZ;
-                }
-
-                if (isValidPosition(nx, ny, nz) && getCell(nx, ny, nz))
-                    count++;
-            }
-    return count;
+size_t Life::wordIndex(int x, int y, int z) const {
+    return (size_t(z) * m_sizeY + y) * m_wordsPerRow + (x >> 6);
 }
 
-int Life::countNeighbors2D(int x, int y, int z) const {
+// Pointers to the rows a cell of row (y, z) takes neighbors from, itself
+// included. Toric wrap-around may list the same row more than once, exactly
+// as the per-cell neighbor walk would count it.
+int Life::gatherRows(int y, int z, const uint64_t* rows[9]) const {
+    bool planar = m_mode == LifeMode::Conway2D || m_mode == LifeMode::Custom2D;
     int count = 0;
-    for (int dy = -1; dy <= 1; ++dy)
-        for (int dx = -1; dx <= 1; ++dx) {
-            if (dx == 0 && dy == 0) continue;
-            int nx = x + dx, ny = y + dy;
 
+    for (int dz = planar ? 0 : -1; dz <= (planar ? 0 : 1); ++dz)
+        for (int dy = -1; dy <= 1; ++dy) {
+            int ny = y + dy, nz = z + dz;
             if (m_toric) {
-                nx = (nx + m_sizeX) % m_sizeX;
                 ny = (ny + m_sizeY) % m_sizeY;
+                nz = (nz + m_sizeZ) % m_sizeZ;
+            } else if (ny < 0 || ny >= m_sizeY || nz < 0 || nz >= m_sizeZ) {
+                continue;
             }
-
-            if (isValidPosition(nx, ny, z) && getCell(nx, ny, z))
-                count++;
+            rows[count++] = m_grid.data() + (size_t(nz) * m_sizeY + ny) * m_wordsPerRow;
         }
     return count;
 }
 
-int Life::getIndex(int x, int y, int z) const {
-    return z * m_sizeX * m_sizeY + y * m_sizeX + x;
-}
-
 bool Life::loadFromFile(const std::string& filename) {
-    std::ifstream file("IO/" + filename + "/initial.txt");
-    if (!file.is_open()) {
+    PROFILE_ZONE("Life::loadFromFile");
+    auto started = std::chrono::steady_clock::now();
+
+    MappedFile file;
+    if (!file.open("IO/" + filename + "/initial.txt")) {
         std::cerr << "Failed to open file: " << filename << std::endl;
         return false;
     }
 
-    clear();
-    std::string line;
-
-    if (!std::getline(file, line)) return false;
-    std::string patternName = line;
+    const char* at = file.data();
+    const char* end = at + file.size();
+    std::string patternName, dims;
+    if (!nextLine(at, end, patternName) || !nextLine(at, end, dims)) return false;
 
-    if (!std::getline(file, line)) return false;
-    size_t p1 = line.find('x');
-    size_t p2 = line.rfind('x');
-    if (p1 == std::string::npos || p2 == std::string::npos || p1 == p2) {
-        std::cerr << "Invalid grid size format: " << line << std::endl;
+    int sizeX, sizeY, sizeZ;
+    if (!parseDims(dims, sizeX, sizeY, sizeZ)) {
+        std::cerr << "Invalid grid size format: " << dims << std::endl;
         return false;
     }
+    allocate(sizeX, sizeY, sizeZ);
 
-    m_sizeX = std::stoi(line.substr(0, p1));
-    m_sizeY = std::stoi(line.substr(p1 + 1, p2 - p1 - 1));
-    m_sizeZ = std::stoi(line.substr(p2 + 1));
+    // One sequential pass finds the L<z> sections; repeated layers keep
+    // their file order so later sections overwrite earlier ones
+    std::vector<std::vector<TextSection>> layers(m_sizeZ);
+    TextSection* current = nullptr; // rows outside a valid layer are ignored
+    while (at < end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(at, '\n', end - at));
+        if (!lineEnd) lineEnd = end;
+        const char* next = lineEnd < end ? lineEnd + 1 : end;
 
-    m_grid.assign(m_sizeX * m_sizeY * m_sizeZ, false);
-    m_next.assign(m_sizeX * m_sizeY * m_sizeZ, false);
-
-    int z = -1;
-    int y = 0;
-
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
-        if (line.size() >= 2 && line[0] == 'L' && isdigit(line[1])) {
-            z = std::stoi(line.substr(1));
-            y = 0;
-            continue;
+        if (lineEnd - at >= 2 && at[0] == 'L' && std::isdigit((unsigned char)at[1])) {
+            long z = std::strtol(at + 1, nullptr, 10);
+            current = nullptr;
+            if (z >= 0 && z < m_sizeZ) {
+                layers[z].push_back({ next, next });
+                current = &layers[z].back();
+            }
+        } else if (current) {
+            current->end = next;
         }
+        at = next;
+    }
 
-        if (z < 0 || z >= m_sizeZ) continue;
-        if (y >= m_sizeY) continue;
+    int threads = std::max(1, std::min<int>(m_sizeZ, int(std::thread::hardware_concurrency())));
+    forEachSlab(m_pool, m_sizeZ, 1, threads, [&](int begin, int stop) {
+        for (int z = begin; z < stop; ++z)
+            for (const TextSection& section : layers[z])
+                parseLayer(section, z);
+    });
+    m_populationValid = false;
 
-        for (int x = 0; x < (int)line.size() && x < m_sizeX; ++x) {
-            char c = line[x];
-            if (c == '0' || c == '1') setCell(x, y, z, c == '1');
-        }
-        ++y;
-    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    m_lastLoad = { file.size(), seconds, m_sizeZ, threads, file.isMapped() };
 
+    double megabytes = file.size() / (1024.0 * 1024.0);
     std::cout << "Loaded pattern '" << patternName
               << "' of size " << m_sizeX << "x" << m_sizeY << "x" << m_sizeZ
-              << std::endl;
+              << std::fixed << std::setprecision(1) << " (" << megabytes << " MB in "
+              << seconds * 1000.0 << " ms, " << (seconds > 0 ? megabytes / seconds : 0.0)
+              << " MB/s, " << threads << " thread(s))" << std::defaultfloat << std::endl;
 
     return true;
 }
 
+// Rows of one L<z> section straight into packed words. As with setCell()
+// per character, '0' and '1' assign and any other character leaves the cell.
+void Life::parseLayer(const TextSection& section, int z) {
+    const bool littleEndian = hostIsLittleEndian();
+    const char* at = section.begin;
+    int y = 0;
+    while (at < section.end && y < m_sizeY) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(at, '\n', section.end - at));
+        if (!lineEnd) lineEnd = section.end;
+        int length = int(std::min<std::ptrdiff_t>(lineEnd - at, m_sizeX));
+
+        if (lineEnd > at) {
+            uint64_t* row = &m_grid[(size_t(z) * m_sizeY + y) * m_wordsPerRow];
+            for (int x0 = 0; x0 < length; x0 += 64) {
+                int count = std::min(64, length - x0);
+                uint64_t ones = 0, zeros = 0;
+                int i = 0;
+                if (littleEndian) {
+                    for (; i + 8 <= count; i += 8) {
+                        uint64_t chunk;
+                        std::memcpy(&chunk, at + x0 + i, 8);
+                        ones |= matchBits8(chunk, 0x3131313131313131ull) << i;
+                        zeros |= matchBits8(chunk, 0x3030303030303030ull) << i;
+                    }
+                }
+                for (; i < count; ++i) {
+                    ones |= uint64_t(at[x0 + i] == '1') << i;
+                    zeros |= uint64_t(at[x0 + i] == '0') << i;
+                }
+                uint64_t& word = row[x0 >> 6];
+                word = (word & ~zeros) | ones;
+            }
+            ++y;
+        }
+        at = lineEnd + 1;
+    }
+}
+
 bool Life::saveToFile(const std::string& name, int step) {
     std::string dir = "IO/" + name + "/log";
     std::filesystem::create_directories(dir);
 
     std::ostringstream oss;
-    oss << dir << "/" << std::setw(5) << std::setfill('0') << step << ".txt";
+    oss << dir << "/" << std::setw(5) << std::setfill('0') << step << ".lifb";
     std::string filepath = oss.str();
 
-    std::ofstream out(filepath);
-    if (!out.is_open()) {
-        std::cerr << "Failed to write file: " << filepath << std::endl;
+    if (!saveBinary(filepath))
         return false;
-    }
 
-    // We can use a reference to a common output stream
-    std::ostream& console = std::cout;
+    if (m_consoleEcho)
+        print(std::cout, name);
 
-    // Write header
-    out << name << "\n";
-    console << name << "\n";
+    return true;
+}
 
+void Life::print(std::ostream& out, const std::string& name) const {
+    out << name << "\n";
     out << m_sizeX << "x" << m_sizeY << "x" << m_sizeZ << "\n";
-    console << m_sizeX << "x" << m_sizeY << "x" << m_sizeZ << "\n";
 
+    std::string line(m_sizeX, '0');
     for (int z = 0; z < m_sizeZ; ++z) {
         out << "L" << z << "\n";
-        console << "L" << z << "\n";
-
         for (int y = 0; y < m_sizeY; ++y) {
-            for (int x = 0; x < m_sizeX; ++x) {
-                char c = getCell(x, y, z) ? '1' : '0';
-                out << c;
-                console << c;
+            for (int x = 0; x < m_sizeX; ++x)
+                line[x] = getCell(x, y, z) ? '1' : '0';
+            out << line << "\n";
+        }
+    }
+}
+
+bool Life::exportToFile(const std::string& path, const std::string& name) const {
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent);
+
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Failed to write file: " << path << std::endl;
+        return false;
+    }
+
+    print(out, name);
+    return bool(out);
+}
+
+bool Life::saveBinary(const std::string& path) const {
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent);
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "Failed to write file: " << path << std::endl;
+        return false;
+    }
+
+    unsigned char header[kBinaryHeaderSize] = {};
+    std::copy(kBinaryMagic, kBinaryMagic + 4, header);
+    putLE(header + 4, kBinaryVersion, 2);
+    putLE(header + 6, kBinaryHeaderSize, 2);
+    putLE(header + 8, uint32_t(m_sizeX), 4);
+    putLE(header + 12, uint32_t(m_sizeY), 4);
+    putLE(header + 16, uint32_t(m_sizeZ), 4);
+    putLE(header + 20, uint32_t(m_wordsPerRow), 4);
+    header[24] = uint8_t(m_mode);
+    header[25] = m_toric ? 1 : 0;
+    putLE(header + 32, uint64_t(m_generation), 8);
+    putLE(header + 40, getPopulation(), 8);
+    putLE(header + 48, checksumWords(m_grid), 8);
+    out.write(reinterpret_cast<const char*>(header), kBinaryHeaderSize);
+
+    if (hostIsLittleEndian()) {
+        out.write(reinterpret_cast<const char*>(m_grid.data()), m_grid.size() * sizeof(uint64_t));
+    } else {
+        unsigned char bytes[8];
+        for (uint64_t w : m_grid) {
+            putLE(bytes, w, 8);
+            out.write(reinterpret_cast<const char*>(bytes), 8);
+        }
+    }
+
+    if (!out) {
+        std::cerr << "Failed to write file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Life::loadBinary(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "Failed to open file: " << path << std::endl;
+        return false;
+    }
+
+    unsigned char header[kBinaryHeaderSize];
+    if (!in.read(reinterpret_cast<char*>(header), kBinaryHeaderSize) ||
+        !std::equal(kBinaryMagic, kBinaryMagic + 4, header)) {
+        std::cerr << "Not a binary Life snapshot: " << path << std::endl;
+        return false;
+    }
+
+    uint64_t version = getLE(header + 4, 2);
+    uint64_t headerSize = getLE(header + 6, 2);
+    if (version != kBinaryVersion || headerSize < kBinaryHeaderSize) {
+        std::cerr << "Unsupported snapshot version " << version << ": " << path << std::endl;
+        return false;
+    }
+
+    int sizeX = int(getLE(header + 8, 4));
+    int sizeY = int(getLE(header + 12, 4));
+    int sizeZ = int(getLE(header + 16, 4));
+    int wordsPerRow = int(getLE(header + 20, 4));
+    uint8_t mode = header[24];
+    if (sizeX <= 0 || sizeY <= 0 || sizeZ <= 0 || wordsPerRow != (sizeX + 63) / 64 ||
+        mode > uint8_t(LifeMode::Custom2D)) {
+        std::cerr << "Invalid snapshot header: " << path << std::endl;
+        return false;
+    }
+
+    // Check the payload is really there before allocating for it
+    size_t wordCount = size_t(wordsPerRow) * sizeY * sizeZ;
+    in.seekg(0, std::ios::end);
+    uint64_t fileSize = uint64_t(in.tellg());
+    if (fileSize < headerSize || (fileSize - headerSize) / sizeof(uint64_t) < wordCount) {
+        std::cerr << "Truncated snapshot: " << path << std::endl;
+        return false;
+    }
+    in.seekg(std::streamoff(headerSize));
+
+    std::vector<uint64_t> words(wordCount);
+    if (hostIsLittleEndian()) {
+        in.read(reinterpret_cast<char*>(words.data()), words.size() * sizeof(uint64_t));
+    } else {
+        unsigned char bytes[8];
+        for (uint64_t& w : words) {
+            in.read(reinterpret_cast<char*>(bytes), 8);
+            w = getLE(bytes, 8);
+        }
+    }
+    if (!in) {
+        std::cerr << "Truncated snapshot: " << path << std::endl;
+        return false;
+    }
+    if (checksumWords(words) != getLE(header + 48, 8)) {
+        std::cerr << "Snapshot checksum mismatch: " << path << std::endl;
+        return false;
+    }
+
+    restore(sizeX, sizeY, sizeZ, std::move(words), (long long)getLE(header + 32, 8));
+    m_mode = LifeMode(mode);
+    m_toric = header[25] != 0;
+
+    if (getPopulation() != getLE(header + 40, 8))
+        std::cerr << "Warning: snapshot population does not match its header: " << path << std::endl;
+
+    return true;
+}
+
+bool Life::loadRLE(const std::string& path) {
+    PROFILE_ZONE("Life::loadRLE");
+    auto started = std::chrono::steady_clock::now();
+
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cerr << "Failed to open file: " << path << std::endl;
+        return false;
+    }
+
+    // Comment lines, then the "x = ..., y = ..." header
+    const char* at = file.data();
+    const char* end = at + file.size();
+    std::string line, name = std::filesystem::path(path).stem().string();
+    bool haveHeader = false;
+    while (!haveHeader && nextLine(at, end, line)) {
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos) continue;
+        if (line[first] == '#') {
+            if (line.compare(first, 2, "#N") == 0) {
+                size_t begin = line.find_first_not_of(" \t", first + 2);
+                size_t last = line.find_last_not_of(" \t\r");
+                if (begin != std::string::npos) name = line.substr(begin, last + 1 - begin);
             }
-            out << "\n";
-            console << "\n";
+            continue;
+        }
+        haveHeader = true;
+    }
+
+    long values[3] = { 0, 0, 1 };
+    std::string rule;
+    if (haveHeader) {
+        std::istringstream fields(line);
+        std::string field;
+        while (std::getline(fields, field, ',')) {
+            size_t equals = field.find('=');
+            if (equals == std::string::npos) continue;
+            std::string key, value;
+            std::istringstream(field.substr(0, equals)) >> key;
+            std::istringstream(field.substr(equals + 1)) >> value;
+            if (key == "x" || key == "y" || key == "z")
+                values[key[0] - 'x'] = std::strtol(value.c_str(), nullptr, 10);
+            else if (key == "rule")
+                rule = value;
+        }
+    }
+    for (long v : values)
+        if (v <= 0 || v > (1L << 24)) {
+            std::cerr << "Invalid RLE header: " << path << std::endl;
+            return false;
+        }
+    int sizeX = int(values[0]), sizeY = int(values[1]), sizeZ = int(values[2]);
+    int wordsPerRow = (sizeX + 63) / 64;
+
+    // Cursor moves by whole runs; only live runs touch the grid
+    std::vector<uint64_t> words(size_t(wordsPerRow) * sizeY * sizeZ, 0);
+    long long x = 0, y = 0, z = 0, run = 0;
+    bool clipped = false, finished = false;
+    for (; at < end && !finished; ++at) {
+        char c = *at;
+        if (c >= '0' && c <= '9') {
+            run = std::min(run * 10 + (c - '0'), 1LL << 40);
+            continue;
+        }
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') continue;
+
+        long long count = run > 0 ? run : 1;
+        run = 0;
+        switch (c) {
+            case 'b': case '.': x += count; break;
+            case '$': y += count; x = 0; break;
+            case '/': z += count; y = 0; x = 0; break;
+            case '!': finished = true; break;
+            case '#': // comment to the end of the line
+                while (at + 1 < end && at[1] != '\n') ++at;
+                break;
+            default:
+                if (!std::isalpha((unsigned char)c)) {
+                    std::cerr << "Invalid character '" << c << "' in RLE file: " << path << std::endl;
+                    return false;
+                }
+                // 'o' and the multi-state letters are all live
+                if (x < sizeX && y < sizeY && z < sizeZ) {
+                    long long visible = std::min<long long>(count, sizeX - x);
+                    fillRun(&words[(size_t(z) * sizeY + size_t(y)) * wordsPerRow], int(x), int(visible));
+                    clipped |= visible < count;
+                } else {
+                    clipped = true;
+                }
+                x += count;
+                break;
+        }
+    }
+
+    if (clipped)
+        std::cerr << "Warning: RLE pattern extends past its " << sizeX << "x" << sizeY << "x" << sizeZ
+                  << " header size and was clipped: " << path << std::endl;
+
+    restore(sizeX, sizeY, sizeZ, std::move(words), 0);
+
+    if (!rule.empty()) {
+        LifeMode mode;
+        bool toric;
+        if (rleModeFor(rule, mode, toric)) {
+            m_mode = mode;
+            m_toric = toric;
+        } else {
+            std::cerr << "Warning: unsupported RLE rule " << rule << ", keeping "
+                      << modeName(m_mode) << ": " << path << std::endl;
         }
     }
 
-    out.close();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    m_lastLoad = { file.size(), seconds, m_sizeZ, 1, file.isMapped() };
+
+    std::cout << "Loaded RLE pattern '" << name << "' of size " << m_sizeX << "x" << m_sizeY << "x" << m_sizeZ
+              << " (" << file.size() << " bytes in " << std::fixed << std::setprecision(1)
+              << seconds * 1000.0 << " ms)" << std::defaultfloat << std::endl;
+    return true;
+}
+
+bool Life::saveRLE(const std::string& path, const std::string& name) const {
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent);
+
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Failed to write file: " << path << std::endl;
+        return false;
+    }
+
+    out << "#N " << name << "\n";
+    out << "#C Generation " << m_generation << "\n";
+    out << "x = " << m_sizeX << ", y = " << m_sizeY;
+    if (m_sizeZ > 1) out << ", z = " << m_sizeZ;
+    out << ", rule = " << rleRuleFor(m_mode);
+    if (m_toric) {
+        out << ":T" << m_sizeX << "," << m_sizeY;
+        if (m_sizeZ > 1) out << "," << m_sizeZ;
+    }
+    out << "\n";
+
+    // Empty rows and planes are only counted; they cost one token when the
+    // next live run appears, and trailing ones cost nothing
+    RleLineWriter writer(out);
+    long long planes = 0;
+    for (int z = 0; z < m_sizeZ; ++z) {
+        if (z > 0) ++planes;
+        int cursorY = 0;
+        for (int y = 0; y < m_sizeY; ++y) {
+            const uint64_t* row = &m_grid[(size_t(z) * m_sizeY + y) * m_wordsPerRow];
+            int start = findCell(row, m_wordsPerRow, m_sizeX, 0, true);
+            if (start >= m_sizeX) continue;
+
+            writer.put(planes, '/');
+            planes = 0;
+            writer.put(y - cursorY, '$');
+            cursorY = y;
 
+            int x = 0;
+            while (start < m_sizeX) {
+                int stop = findCell(row, m_wordsPerRow, m_sizeX, start, false);
+                writer.put(start - x, 'b');
+                writer.put(stop - start, 'o');
+                x = stop;
+                start = findCell(row, m_wordsPerRow, m_sizeX, stop, true);
+            }
+        }
+    }
+    writer.finish();
+
+    if (!out) {
+        std::cerr << "Failed to write file: " << path << std::endl;
+        return false;
+    }
     return true;
 }
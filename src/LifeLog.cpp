@@ -0,0 +1,455 @@
+#include "LifeLog.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+
+const char kLogMagic[4] = { 'L', 'I', 'F', 'L' };
+const uint16_t kLogVersion = 1;
+const size_t kLogHeaderSize = 32;
+const uint8_t kKeyframe = 1;
+const uint8_t kDelta = 2;
+const uint8_t kRawPayload = 0x80; // type flag: every word stored, no skip counts
+
+// Index sidecar (<log>.idx, little-endian):
+//   0  "LIFX"   4  version u16   6  header size u16
+//   8  log size u64   16  frame count u64   24  entry size u32
+// then per frame: payload offset u64, payload size u64, generation i64,
+// population u64, checksum u32, type u8, mode u8, toric u8, one pad byte
+const char kIndexMagic[4] = { 'L', 'I', 'F', 'X' };
+const uint16_t kIndexVersion = 1;
+const size_t kIndexHeaderSize = 32;
+const size_t kIndexEntrySize = 40;
+
+void putLE(unsigned char* out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) out[i] = (unsigned char)(value >> (8 * i));
+}
+
+uint64_t getLE(const unsigned char* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) value |= uint64_t(in[i]) << (8 * i);
+    return value;
+}
+
+// LEB128: 7 bits per byte, high bit set on all but the last
+void putVarint(std::vector<unsigned char>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((unsigned char)value);
+}
+
+bool getVarint(const unsigned char*& in, const unsigned char* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; in < end && shift < 64; shift += 7) {
+        unsigned char byte = *in++;
+        value |= uint64_t(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+bool readVarint(std::istream& in, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = in.get();
+        if (byte == EOF) return false;
+        value |= uint64_t(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+uint32_t checksumBytes(const std::vector<unsigned char>& bytes) {
+    uint32_t hash = 2166136261u;
+    for (unsigned char b : bytes) {
+        hash ^= b;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+} // namespace
+
+LifeLogWriter::~LifeLogWriter() {
+    close();
+}
+
+bool LifeLogWriter::open(const std::string& path, int sizeX, int sizeY, int sizeZ, int keyframeInterval) {
+    close();
+
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    std::error_code error;
+    if (!parent.empty()) std::filesystem::create_directories(parent, error);
+
+    m_out.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_out.is_open()) {
+        std::cerr << "Failed to write file: " << path << std::endl;
+        return false;
+    }
+
+    m_path = path;
+    m_sizeX = sizeX;
+    m_sizeY = sizeY;
+    m_sizeZ = sizeZ;
+    m_keyframeInterval = std::max(1, keyframeInterval);
+    m_index.clear();
+    std::error_code ignored;
+    std::filesystem::remove(path + ".idx", ignored); // describes the old log
+    m_previous.assign(size_t((sizeX + 63) / 64) * sizeY * sizeZ, 0);
+
+    unsigned char header[kLogHeaderSize] = {};
+    std::copy(kLogMagic, kLogMagic + 4, header);
+    putLE(header + 4, kLogVersion, 2);
+    putLE(header + 6, kLogHeaderSize, 2);
+    putLE(header + 8, uint32_t(sizeX), 4);
+    putLE(header + 12, uint32_t(sizeY), 4);
+    putLE(header + 16, uint32_t(sizeZ), 4);
+    putLE(header + 20, uint32_t(m_keyframeInterval), 4);
+    m_out.write(reinterpret_cast<const char*>(header), kLogHeaderSize);
+    m_bytes = kLogHeaderSize;
+
+    return bool(m_out);
+}
+
+void LifeLogWriter::close() {
+    if (!m_out.is_open()) return;
+    m_out.close();
+    writeIndex();
+}
+
+void LifeLogWriter::writeIndex() {
+    std::ofstream out(m_path + ".idx", std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return; // readers fall back to scanning the log
+
+    unsigned char header[kIndexHeaderSize] = {};
+    std::copy(kIndexMagic, kIndexMagic + 4, header);
+    putLE(header + 4, kIndexVersion, 2);
+    putLE(header + 6, kIndexHeaderSize, 2);
+    putLE(header + 8, m_bytes, 8);
+    putLE(header + 16, m_index.size(), 8);
+    putLE(header + 24, kIndexEntrySize, 4);
+    out.write(reinterpret_cast<const char*>(header), kIndexHeaderSize);
+
+    std::vector<unsigned char> entries(m_index.size() * kIndexEntrySize, 0);
+    for (size_t i = 0; i < m_index.size(); ++i) {
+        const IndexEntry& e = m_index[i];
+        unsigned char* at = &entries[i * kIndexEntrySize];
+        putLE(at, e.offset, 8);
+        putLE(at + 8, e.size, 8);
+        putLE(at + 16, uint64_t(e.generation), 8);
+        putLE(at + 24, e.population, 8);
+        putLE(at + 32, e.checksum, 4);
+        at[36] = e.type;
+        at[37] = uint8_t(e.mode);
+        at[38] = e.toric ? 1 : 0;
+    }
+    out.write(reinterpret_cast<const char*>(entries.data()), entries.size());
+}
+
+bool LifeLogWriter::append(const Life& life) {
+    return appendFrame(life.getSizeX(), life.getSizeY(), life.getSizeZ(), life.getWords(),
+                       life.getGeneration(), life.getPopulation(), life.getMode(), life.isToric());
+}
+
+bool LifeLogWriter::append(const LifeSnapshot& snapshot) {
+    return appendFrame(snapshot.getSizeX(), snapshot.getSizeY(), snapshot.getSizeZ(), snapshot.getWords(),
+                       snapshot.getGeneration(), snapshot.getPopulation(), snapshot.getMode(), snapshot.isToric());
+}
+
+bool LifeLogWriter::appendFrame(int sizeX, int sizeY, int sizeZ, const std::vector<uint64_t>& words,
+                                long long generation, size_t population, LifeMode mode, bool toric) {
+    if (!m_out.is_open()) return false;
+    if (sizeX != m_sizeX || sizeY != m_sizeY || sizeZ != m_sizeZ || words.size() != m_previous.size()) {
+        std::cerr << "Log " << m_path << " is for a " << m_sizeX << "x" << m_sizeY << "x" << m_sizeZ
+                  << " grid, not " << sizeX << "x" << sizeY << "x" << sizeZ << std::endl;
+        return false;
+    }
+
+    // A keyframe is a delta against an empty grid
+    bool keyframe = m_index.size() % m_keyframeInterval == 0;
+    if (keyframe) std::fill(m_previous.begin(), m_previous.end(), 0);
+
+    m_payload.clear();
+    uint64_t skipped = 0;
+    size_t rawSize = words.size() * 8;
+    for (size_t i = 0; i < words.size() && m_payload.size() < rawSize; ++i) {
+        uint64_t diff = words[i] ^ m_previous[i];
+        if (diff == 0) {
+            ++skipped;
+            continue;
+        }
+        putVarint(m_payload, skipped);
+        size_t at = m_payload.size();
+        m_payload.resize(at + 8);
+        putLE(&m_payload[at], diff, 8);
+        skipped = 0;
+    }
+
+    // Chaotic frames change most words; then the plain XOR is smaller
+    bool raw = m_payload.size() >= rawSize;
+    if (raw) {
+        m_payload.resize(rawSize);
+        for (size_t i = 0; i < words.size(); ++i)
+            putLE(&m_payload[i * 8], words[i] ^ m_previous[i], 8);
+    }
+    m_previous = words;
+
+    uint8_t type = (keyframe ? kKeyframe : kDelta) | (raw ? kRawPayload : 0);
+    std::vector<unsigned char> header = { type, uint8_t(mode), uint8_t(toric ? 1 : 0) };
+    putVarint(header, uint64_t(generation));
+    putVarint(header, population);
+    putVarint(header, m_payload.size());
+    size_t at = header.size();
+    uint32_t checksum = checksumBytes(m_payload);
+    header.resize(at + 4);
+    putLE(&header[at], checksum, 4);
+
+    m_out.write(reinterpret_cast<const char*>(header.data()), header.size());
+    m_out.write(reinterpret_cast<const char*>(m_payload.data()), m_payload.size());
+    m_out.flush();
+    if (!m_out) {
+        std::cerr << "Failed to append to log: " << m_path << std::endl;
+        return false;
+    }
+
+    m_index.push_back({ m_bytes + header.size(), m_payload.size(), generation, population,
+                        checksum, type, mode, toric });
+    m_bytes += header.size() + m_payload.size();
+    return true;
+}
+
+bool LifeLogReader::open(const std::string& path) {
+    close();
+
+    m_in.open(path, std::ios::binary);
+    if (!m_in.is_open()) {
+        std::cerr << "Failed to open file: " << path << std::endl;
+        return false;
+    }
+    m_path = path;
+
+    unsigned char header[kLogHeaderSize];
+    if (!m_in.read(reinterpret_cast<char*>(header), kLogHeaderSize) ||
+        !std::equal(kLogMagic, kLogMagic + 4, header)) {
+        std::cerr << "Not a Life log: " << path << std::endl;
+        close();
+        return false;
+    }
+    uint64_t version = getLE(header + 4, 2);
+    uint64_t headerSize = getLE(header + 6, 2);
+    if (version != kLogVersion || headerSize < kLogHeaderSize) {
+        std::cerr << "Unsupported log version " << version << ": " << path << std::endl;
+        close();
+        return false;
+    }
+
+    m_sizeX = int(getLE(header + 8, 4));
+    m_sizeY = int(getLE(header + 12, 4));
+    m_sizeZ = int(getLE(header + 16, 4));
+    m_keyframeInterval = int(getLE(header + 20, 4));
+    if (m_sizeX <= 0 || m_sizeY <= 0 || m_sizeZ <= 0) {
+        std::cerr << "Invalid log header: " << path << std::endl;
+        close();
+        return false;
+    }
+
+    m_in.seekg(0, std::ios::end);
+    uint64_t fileSize = uint64_t(m_in.tellg());
+    m_usedIndex = loadIndex(path + ".idx", fileSize);
+    if (!m_usedIndex) scanFrames(headerSize, fileSize);
+
+    m_ascending = true;
+    for (size_t f = 1; f < m_frames.size() && m_ascending; ++f)
+        m_ascending = m_frames[f].generation >= m_frames[f - 1].generation;
+
+    m_current.assign(size_t((m_sizeX + 63) / 64) * m_sizeY * m_sizeZ, 0);
+    m_currentFrame = -1;
+    return true;
+}
+
+// Indexes the frames by walking their headers; a frame cut short by a crash
+// ends the log
+void LifeLogReader::scanFrames(uint64_t headerSize, uint64_t fileSize) {
+    m_in.seekg(std::streamoff(headerSize));
+    for (;;) {
+        int type = m_in.get();
+        if (type == EOF) break;
+
+        unsigned char flags[2] = {};
+        unsigned char sum[4];
+        uint64_t generation, population, size;
+        bool complete = m_in.read(reinterpret_cast<char*>(flags), 2) &&
+                        readVarint(m_in, generation) && readVarint(m_in, population) &&
+                        readVarint(m_in, size) && m_in.read(reinterpret_cast<char*>(sum), 4);
+        uint64_t offset = complete ? uint64_t(m_in.tellg()) : 0;
+        uint8_t kind = uint8_t(type) & ~kRawPayload;
+        bool valid = (kind == kKeyframe || kind == kDelta) && flags[0] <= uint8_t(LifeMode::Custom2D);
+
+        if (!complete || !valid || offset + size > fileSize) {
+            std::cerr << "Log " << m_path << " ends with an incomplete frame after "
+                      << m_frames.size() << " frame(s)" << std::endl;
+            break;
+        }
+        if (m_frames.empty() && kind != kKeyframe) {
+            std::cerr << "Log " << m_path << " does not start with a keyframe" << std::endl;
+            break;
+        }
+
+        m_frames.push_back({ offset, size, kind == kKeyframe, (type & kRawPayload) != 0,
+                             LifeMode(flags[0]), flags[1] != 0,
+                             (long long)generation, population, uint32_t(getLE(sum, 4)) });
+        m_in.seekg(std::streamoff(offset + size));
+    }
+    m_in.clear();
+}
+
+// The writer's index, if it still describes a log of exactly logSize bytes
+bool LifeLogReader::loadIndex(const std::string& path, uint64_t logSize) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+
+    unsigned char header[kIndexHeaderSize];
+    if (!in.read(reinterpret_cast<char*>(header), kIndexHeaderSize) ||
+        !std::equal(kIndexMagic, kIndexMagic + 4, header) ||
+        getLE(header + 4, 2) != kIndexVersion || getLE(header + 8, 8) != logSize ||
+        getLE(header + 24, 4) != kIndexEntrySize)
+        return false;
+
+    uint64_t count = getLE(header + 16, 8);
+    in.seekg(0, std::ios::end);
+    uint64_t indexSize = uint64_t(in.tellg());
+    uint64_t headerSize = getLE(header + 6, 2);
+    if (indexSize < headerSize || (indexSize - headerSize) / kIndexEntrySize < count)
+        return false;
+    in.seekg(std::streamoff(headerSize));
+
+    std::vector<unsigned char> entries(size_t(count) * kIndexEntrySize);
+    if (!in.read(reinterpret_cast<char*>(entries.data()), entries.size()))
+        return false;
+
+    std::vector<Frame> frames;
+    frames.reserve(size_t(count));
+    for (size_t i = 0; i < count; ++i) {
+        const unsigned char* at = &entries[i * kIndexEntrySize];
+        uint64_t offset = getLE(at, 8), size = getLE(at + 8, 8);
+        uint8_t kind = at[36] & ~kRawPayload;
+        if ((kind != kKeyframe && kind != kDelta) || at[37] > uint8_t(LifeMode::Custom2D) ||
+            offset > logSize || size > logSize - offset || (i == 0 && kind != kKeyframe))
+            return false;
+        frames.push_back({ offset, size, kind == kKeyframe, (at[36] & kRawPayload) != 0,
+                           LifeMode(at[37]), at[38] != 0,
+                           (long long)getLE(at + 16, 8), getLE(at + 24, 8), uint32_t(getLE(at + 32, 4)) });
+    }
+    m_frames = std::move(frames);
+    return true;
+}
+
+void LifeLogReader::close() {
+    if (m_in.is_open()) m_in.close();
+    m_frames.clear();
+    m_current.clear();
+    m_currentFrame = -1;
+}
+
+bool LifeLogReader::applyFrame(size_t frame) {
+    const Frame& f = m_frames[frame];
+    m_payload.resize(f.size);
+    m_in.seekg(std::streamoff(f.offset));
+    if (!m_in.read(reinterpret_cast<char*>(m_payload.data()), f.size) ||
+        checksumBytes(m_payload) != f.checksum) {
+        std::cerr << "Corrupt frame " << frame << " in log " << m_path << std::endl;
+        m_in.clear();
+        return false;
+    }
+
+    if (f.keyframe) std::fill(m_current.begin(), m_current.end(), 0);
+
+    if (f.raw) {
+        if (m_payload.size() != m_current.size() * 8) {
+            std::cerr << "Corrupt frame " << frame << " in log " << m_path << std::endl;
+            return false;
+        }
+        for (size_t i = 0; i < m_current.size(); ++i)
+            m_current[i] ^= getLE(&m_payload[i * 8], 8);
+        return true;
+    }
+
+    const unsigned char* in = m_payload.data();
+    const unsigned char* end = in + m_payload.size();
+    size_t word = 0;
+    while (in < end) {
+        uint64_t skipped;
+        if (!getVarint(in, end, skipped) || end - in < 8 || skipped >= m_current.size() - word) {
+            std::cerr << "Corrupt frame " << frame << " in log " << m_path << std::endl;
+            return false;
+        }
+        word += skipped;
+        m_current[word++] ^= getLE(in, 8);
+        in += 8;
+    }
+    return true;
+}
+
+long long LifeLogReader::findFrame(long long generation) const {
+    if (m_frames.empty()) return -1;
+    if (m_ascending) {
+        auto after = std::upper_bound(m_frames.begin(), m_frames.end(), generation,
+                                      [](long long g, const Frame& f) { return g < f.generation; });
+        return after == m_frames.begin() ? 0 : (long long)(after - m_frames.begin()) - 1;
+    }
+    // Generations went back (a snapshot loaded mid-run): the last match wins
+    for (size_t f = m_frames.size(); f-- > 0;)
+        if (m_frames[f].generation <= generation) return (long long)f;
+    return 0;
+}
+
+bool LifeLogReader::readWords(size_t frame, std::vector<uint64_t>& words) {
+    if (frame >= m_frames.size()) return false;
+
+    // Decode from the nearest keyframe, unless the last frame read is closer:
+    // forward from it by applying deltas, or back by undoing them
+    size_t start = frame;
+    while (!m_frames[start].keyframe) --start;
+    size_t current = size_t(m_currentFrame);
+    if (m_currentFrame >= 0 && current > frame && current - frame < frame - start + 1) {
+        size_t back = current;
+        while (back > frame && !m_frames[back].keyframe) --back;
+        if (back == frame) {
+            for (size_t f = current; f > frame; --f) {
+                if (!applyFrame(f)) {
+                    m_currentFrame = -1;
+                    return false;
+                }
+                m_currentFrame = (long long)f - 1;
+            }
+            words = m_current;
+            return true;
+        }
+    }
+    if (m_currentFrame >= 0 && current <= frame && current >= start)
+        start = current + 1;
+
+    for (size_t f = start; f <= frame; ++f) {
+        if (!applyFrame(f)) {
+            m_currentFrame = -1;
+            return false;
+        }
+        m_currentFrame = (long long)f;
+    }
+
+    words = m_current;
+    return true;
+}
+
+bool LifeLogReader::read(size_t frame, Life& life) {
+    std::vector<uint64_t> words;
+    if (!readWords(frame, words)) return false;
+    if (!life.restore(m_sizeX, m_sizeY, m_sizeZ, std::move(words), m_frames[frame].generation))
+        return false;
+    life.setMode(m_frames[frame].mode);
+    life.setToric(m_frames[frame].toric);
+    return true;
+}
@@ -0,0 +1,36 @@
+#include "LifeSnapshot.h"
+
+bool LifeSnapshot::getCell(int x, int y, int z) const {
+    if (m_toric) {
+        x = (x + m_sizeX) % m_sizeX;
+        y = (y + m_sizeY) % m_sizeY;
+        z = (z + m_sizeZ) % m_sizeZ;
+    } else if (!isValidPosition(x, y, z)) {
+        return false;
+    }
+    size_t index = (size_t(z) * m_sizeY + y) * m_wordsPerRow + (x >> 6);
+    return (m_words[index] >> (x & 63)) & 1;
+}
+
+float LifeSnapshot::computeDensity(int x, int y, int z, int radius) const {
+    int count = 0;
+    int maxNeighbors = 0;
+
+    for (int dz = -radius; dz <= radius; ++dz)
+        for (int dy = -radius; dy <= radius; ++dy)
+            for (int dx = -radius; dx <= radius; ++dx) {
+                int nx = x + dx, ny = y + dy, nz = z + dz;
+                if (m_toric || isValidPosition(nx, ny, nz)) {
+                    maxNeighbors++;
+                    if (getCell(nx, ny, nz)) count++;
+                }
+            }
+
+    return maxNeighbors > 0 ? float(count) / float(maxNeighbors) : 0.0f;
+}
+
+bool LifeSnapshot::isValidPosition(int x, int y, int z) const {
+    return x >= 0 && x < m_sizeX &&
+           y >= 0 && y < m_sizeY &&
+           z >= 0 && z < m_sizeZ;
+}
@@ -0,0 +1,42 @@
+#include "LogReplay.h"
+#include "Profiler.h"
+#include <iostream>
+
+bool LogReplay::open(const std::string& path) {
+    close();
+    if (!m_reader.open(path)) return false;
+    if (m_reader.getFrameCount() == 0) {
+        std::cerr << "Log " << path << " has no frames to replay" << std::endl;
+        m_reader.close();
+        return false;
+    }
+    m_frame = 0;
+    m_forward = true;
+    m_open = true;
+    return true;
+}
+
+void LogReplay::close() {
+    m_reader.close();
+    m_open = false;
+    m_frame = 0;
+}
+
+bool LogReplay::seek(long long generation, Life& life) {
+    if (!m_open) return false;
+    return seekFrame(size_t(m_reader.findFrame(generation)), life);
+}
+
+bool LogReplay::seekFrame(size_t frame, Life& life) {
+    PROFILE_ZONE("LogReplay::seek");
+    if (!m_open || frame >= getFrameCount()) return false;
+    if (!m_reader.read(frame, life)) return false;
+    m_frame = frame;
+    return true;
+}
+
+bool LogReplay::step(Life& life) {
+    if (!m_open) return false;
+    if (m_forward ? m_frame + 1 >= getFrameCount() : m_frame == 0) return false;
+    return seekFrame(m_forward ? m_frame + 1 : m_frame - 1, life);
+}
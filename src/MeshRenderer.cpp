@@ -0,0 +1,270 @@
+#include "MeshRenderer.h"
+#include "Frustum.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstddef>
+
+namespace {
+
+int trailingZeros64(uint64_t v) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(v);
+#else
+    int n = 0;
+    for (; !(v & 1); v >>= 1) ++n;
+    return n;
+#endif
+}
+
+int leadingZeros64(uint64_t v) {
+#if defined(__GNUC__)
+    return __builtin_clzll(v);
+#else
+    int n = 0;
+    for (; !(v >> 63); v <<= 1) ++n;
+    return n;
+#endif
+}
+
+// Faces in the order -x, +x, -y, +y, -z, +z; corners wind outwards
+const float kFaceCorners[6][4][3] = {
+    { {-0.5f,-0.5f,-0.5f}, {-0.5f,-0.5f, 0.5f}, {-0.5f, 0.5f, 0.5f}, {-0.5f, 0.5f,-0.5f} },
+    { { 0.5f,-0.5f,-0.5f}, { 0.5f, 0.5f,-0.5f}, { 0.5f, 0.5f, 0.5f}, { 0.5f,-0.5f, 0.5f} },
+    { {-0.5f,-0.5f,-0.5f}, { 0.5f,-0.5f,-0.5f}, { 0.5f,-0.5f, 0.5f}, {-0.5f,-0.5f, 0.5f} },
+    { {-0.5f, 0.5f,-0.5f}, {-0.5f, 0.5f, 0.5f}, { 0.5f, 0.5f, 0.5f}, { 0.5f, 0.5f,-0.5f} },
+    { {-0.5f,-0.5f,-0.5f}, {-0.5f, 0.5f,-0.5f}, { 0.5f, 0.5f,-0.5f}, { 0.5f,-0.5f,-0.5f} },
+    { {-0.5f,-0.5f, 0.5f}, { 0.5f,-0.5f, 0.5f}, { 0.5f, 0.5f, 0.5f}, {-0.5f, 0.5f, 0.5f} },
+};
+
+} // namespace
+
+MeshRenderer::MeshRenderer(Coloring& coloring, Palette& palette)
+    : m_coloring(coloring), m_palette(palette)
+{}
+
+MeshRenderer::~MeshRenderer() {
+    releaseChunks();
+}
+
+void MeshRenderer::releaseChunks() {
+    for (Chunk& c : m_chunks) {
+        if (c.vao) glDeleteVertexArrays(1, &c.vao);
+        if (c.vbo) glDeleteBuffers(1, &c.vbo);
+        if (c.ebo) glDeleteBuffers(1, &c.ebo);
+    }
+    m_chunks.clear();
+}
+
+void MeshRenderer::reset(const LifeSnapshot& life) {
+    releaseChunks();
+    m_sizeX = life.getSizeX();
+    m_sizeY = life.getSizeY();
+    m_sizeZ = life.getSizeZ();
+    m_toric = life.isToric();
+    m_byDepth = Coloring::shadesByDepth(m_coloring.getPattern());
+
+    m_chunksX = life.getWordsPerRow();
+    m_chunksY = (m_sizeY + kChunkY - 1) / kChunkY;
+    m_chunksZ = (m_sizeZ + kChunkZ - 1) / kChunkZ;
+    m_chunks.resize(size_t(m_chunksX) * m_chunksY * m_chunksZ);
+    m_previous = life.getWords();
+    m_valid = true;
+}
+
+void MeshRenderer::markRange(int x0, int x1, int y0, int y1, int z0, int z1) {
+    // Chunk indices along one axis covering cells lo..hi, wrapped or clipped
+    auto collect = [&](int lo, int hi, int size, int chunk, int count, std::vector<int>& out) {
+        out.clear();
+        if (hi - lo + 1 >= size) {
+            for (int c = 0; c < count; ++c) out.push_back(c);
+            return;
+        }
+        for (int v = lo; v <= hi; ++v) {
+            int cell = v;
+            if (cell < 0 || cell >= size) {
+                if (!m_toric) continue;
+                cell = (cell % size + size) % size;
+            }
+            int c = cell / chunk;
+            if (std::find(out.begin(), out.end(), c) == out.end()) out.push_back(c);
+        }
+    };
+    collect(x0, x1, m_sizeX, kChunkX, m_chunksX, m_rangeX);
+    collect(y0, y1, m_sizeY, kChunkY, m_chunksY, m_rangeY);
+    collect(z0, z1, m_sizeZ, kChunkZ, m_chunksZ, m_rangeZ);
+
+    for (int cz : m_rangeZ)
+        for (int cy : m_rangeY)
+            for (int cx : m_rangeX)
+                m_chunks[(size_t(cz) * m_chunksY + cy) * m_chunksX + cx].dirty = true;
+}
+
+void MeshRenderer::markChanges(const LifeSnapshot& life) {
+    PROFILE_ZONE("MeshRenderer::diff");
+    const std::vector<uint64_t>& words = life.getWords();
+    const int wordsPerRow = life.getWordsPerRow();
+
+    // A cell decides its own faces, its neighbors' faces and, through the
+    // density, the shade of every cell within the coloring radius
+    int margin = 1;
+    if (!m_byDepth) margin = std::max(margin, m_coloring.getRadius());
+
+    size_t row = 0;
+    for (int z = 0; z < m_sizeZ; ++z)
+        for (int y = 0; y < m_sizeY; ++y, row += wordsPerRow)
+            for (int w = 0; w < wordsPerRow; ++w) {
+                uint64_t diff = words[row + w] ^ m_previous[row + w];
+                if (!diff) continue;
+                int lo = (w << 6) + trailingZeros64(diff);
+                int hi = (w << 6) + 63 - leadingZeros64(diff);
+                markRange(lo - margin, hi + margin, y - margin, y + margin, z - margin, z + margin);
+            }
+
+    m_previous = words;
+}
+
+void MeshRenderer::rebuildChunk(const LifeSnapshot& life, int cx, int cy, int cz) {
+    const std::vector<uint64_t>& words = life.getWords();
+    const int wordsPerRow = life.getWordsPerRow();
+    const int w = cx;
+    const int lastX = m_sizeX - 1;
+    const bool lastWord = w == (lastX >> 6);
+
+    m_vertices.clear();
+    m_indices.clear();
+
+    auto rowOf = [&](int y, int z) { return (size_t(z) * m_sizeY + y) * wordsPerRow; };
+    // Word w of a neighboring row, wrapped on a torus and dead past the edge otherwise
+    auto neighborWord = [&](int y, int z) -> uint64_t {
+        if (y < 0 || y >= m_sizeY || z < 0 || z >= m_sizeZ) {
+            if (!m_toric) return 0;
+            y = (y + m_sizeY) % m_sizeY;
+            z = (z + m_sizeZ) % m_sizeZ;
+        }
+        return words[rowOf(y, z) + w];
+    };
+
+    int yEnd = std::min(m_sizeY, (cy + 1) * kChunkY);
+    int zEnd = std::min(m_sizeZ, (cz + 1) * kChunkZ);
+    for (int z = cz * kChunkZ; z < zEnd; ++z)
+        for (int y = cy * kChunkY; y < yEnd; ++y) {
+            size_t row = rowOf(y, z);
+            uint64_t live = words[row + w];
+            if (!live) continue;
+
+            // Neighbors of every cell in the word, one mask per face direction
+            uint64_t neighbors[6];
+            neighbors[0] = (live << 1) | (w > 0 ? words[row + w - 1] >> 63 : 0);
+            neighbors[1] = (live >> 1) | (w + 1 < wordsPerRow ? words[row + w + 1] << 63 : 0);
+            if (m_toric) {
+                if (w == 0 && ((words[row + (lastX >> 6)] >> (lastX & 63)) & 1))
+                    neighbors[0] |= 1;
+                if (lastWord && (words[row] & 1))
+                    neighbors[1] |= uint64_t(1) << (lastX & 63);
+            }
+            neighbors[2] = neighborWord(y - 1, z);
+            neighbors[3] = neighborWord(y + 1, z);
+            neighbors[4] = neighborWord(y, z - 1);
+            neighbors[5] = neighborWord(y, z + 1);
+
+            uint64_t faces[6];
+            uint64_t any = 0;
+            for (int d = 0; d < 6; ++d) {
+                faces[d] = live & ~neighbors[d];
+                any |= faces[d];
+            }
+
+            for (uint64_t bits = any; bits; bits &= bits - 1) {
+                int bit = trailingZeros64(bits);
+                int x = (w << 6) + bit;
+                uint32_t shade = m_coloring.getShade(life, x, y, z);
+                float px = x - m_sizeX / 2.0f, py = y - m_sizeY / 2.0f, pz = z - m_sizeZ / 2.0f;
+
+                for (int d = 0; d < 6; ++d) {
+                    if (!((faces[d] >> bit) & 1)) continue;
+                    uint32_t first = uint32_t(m_vertices.size());
+                    for (const float* corner : kFaceCorners[d])
+                        m_vertices.push_back({ px + corner[0], py + corner[1], pz + corner[2], shade });
+                    for (uint32_t i : { 0u, 1u, 2u, 2u, 3u, 0u })
+                        m_indices.push_back(first + i);
+                }
+            }
+        }
+
+    Chunk& chunk = m_chunks[(size_t(cz) * m_chunksY + cy) * m_chunksX + cx];
+    if (!chunk.vao) {
+        glGenVertexArrays(1, &chunk.vao);
+        glGenBuffers(1, &chunk.vbo);
+        glGenBuffers(1, &chunk.ebo);
+
+        glBindVertexArray(chunk.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, chunk.vbo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, chunk.ebo);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, x));
+        glEnableVertexAttribArray(1);
+        glVertexAttribIPointer(1, 1, GL_UNSIGNED_BYTE, sizeof(Vertex), (void*)offsetof(Vertex, shade));
+    } else {
+        glBindVertexArray(chunk.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, chunk.vbo);
+    }
+
+    // Respecifying the stores orphans whatever a queued draw still reads
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(m_vertices.size() * sizeof(Vertex)), m_vertices.data(), GL_DYNAMIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, GLsizeiptr(m_indices.size() * sizeof(uint32_t)), m_indices.data(), GL_DYNAMIC_DRAW);
+    glBindVertexArray(0);
+
+    chunk.min = glm::vec3(cx * kChunkX - m_sizeX / 2.0f - 0.5f, cy * kChunkY - m_sizeY / 2.0f - 0.5f,
+                          cz * kChunkZ - m_sizeZ / 2.0f - 0.5f);
+    chunk.max = chunk.min + glm::vec3(float(kChunkX), float(kChunkY), float(kChunkZ));
+    chunk.indexCount = GLsizei(m_indices.size());
+    chunk.faces = m_indices.size() / 6;
+    chunk.dirty = false;
+    ++m_chunkRebuilds;
+}
+
+void MeshRenderer::render(const LifeSnapshot& life, Shader& shader, const glm::mat4& view, const glm::mat4& projection) {
+    PROFILE_ZONE("MeshRenderer::render");
+
+    bool reshaped = !m_valid || life.getSizeX() != m_sizeX || life.getSizeY() != m_sizeY ||
+                    life.getSizeZ() != m_sizeZ || life.isToric() != m_toric ||
+                    Coloring::shadesByDepth(m_coloring.getPattern()) != m_byDepth;
+    if (reshaped)
+        reset(life);
+    else if (life.getRevision() != m_revision || life.getGeneration() != m_generation)
+        markChanges(life);
+    m_revision = life.getRevision();
+    m_generation = life.getGeneration();
+
+    {
+        PROFILE_ZONE("MeshRenderer::mesh");
+        m_faces = 0;
+        for (int cz = 0; cz < m_chunksZ; ++cz)
+            for (int cy = 0; cy < m_chunksY; ++cy)
+                for (int cx = 0; cx < m_chunksX; ++cx) {
+                    Chunk& chunk = m_chunks[(size_t(cz) * m_chunksY + cy) * m_chunksX + cx];
+                    if (chunk.dirty) rebuildChunk(life, cx, cy, cz);
+                    m_faces += chunk.faces;
+                }
+    }
+
+    shader.use();
+    shader.setUniform("view", view);
+    shader.setUniform("projection", projection);
+    shader.setUniform("palette", 0);
+    m_palette.bind(0);
+
+    PROFILE_ZONE("MeshRenderer::draw");
+    Frustum frustum(projection * view);
+    m_culledChunks = 0;
+    for (const Chunk& chunk : m_chunks) {
+        if (!chunk.indexCount) continue;
+        if (!frustum.intersects(chunk.min, chunk.max)) {
+            ++m_culledChunks;
+            continue;
+        }
+        glBindVertexArray(chunk.vao);
+        glDrawElements(GL_TRIANGLES, chunk.indexCount, GL_UNSIGNED_INT, nullptr);
+    }
+    glBindVertexArray(0);
+}
@@ -0,0 +1,36 @@
+#include "Palette.h"
+#include "Profiler.h"
+
+Palette::Palette(const Coloring& coloring)
+    : m_coloring(coloring)
+{
+    glGenTextures(1, &m_texture);
+    glBindTexture(GL_TEXTURE_1D, m_texture);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA8, Coloring::kPaletteSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_1D, 0);
+}
+
+Palette::~Palette() {
+    if (m_texture) glDeleteTextures(1, &m_texture);
+}
+
+void Palette::bind(int unit) {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_1D, m_texture);
+
+    ColoringPattern pattern = m_coloring.getPattern();
+    if (m_valid && pattern == m_pattern) return;
+
+    PROFILE_ZONE("Palette::upload");
+    uint32_t colors[Coloring::kPaletteSize];
+    m_coloring.buildPalette(pattern, colors);
+    glTexSubImage1D(GL_TEXTURE_1D, 0, 0, Coloring::kPaletteSize, GL_RGBA, GL_UNSIGNED_BYTE, colors);
+    m_pattern = pattern;
+    m_valid = true;
+    ++m_uploads;
+}
@@ -0,0 +1,150 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// Fields are relaxed atomics so the exporter can read a slot while its
+// owner overwrites it; torn slots are detected through the head counter
+struct ProfileEvent {
+    std::atomic<const char*> name{nullptr};
+    std::atomic<int64_t> start{0};
+    std::atomic<int64_t> end{0};
+};
+
+// Single-producer ring owned by one thread at a time
+struct ProfileRing {
+    std::unique_ptr<ProfileEvent[]> events{new ProfileEvent[Profiler::kRingSize]};
+    std::atomic<uint64_t> head{0};     // events written so far
+    std::atomic<uint64_t> cleared{0};  // head value at the last clear()
+    std::atomic<bool> owned{true};
+    int threadId = 0;
+    std::string threadName;            // guarded by registryMutex
+};
+
+// Rings are only ever added, so exported pointers stay valid. Threads that
+// exit hand their ring back for the next new thread to reuse.
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ProfileRing>> registry;
+
+struct RingOwner {
+    ProfileRing* ring = nullptr;
+    ~RingOwner() { if (ring) ring->owned = false; }
+};
+
+ProfileRing& threadRing() {
+    thread_local RingOwner owner;
+    if (owner.ring) return *owner.ring;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (auto& ring : registry) {
+        bool expected = false;
+        if (ring->owned.compare_exchange_strong(expected, true)) {
+            owner.ring = ring.get();
+            return *owner.ring;
+        }
+    }
+    registry.push_back(std::make_unique<ProfileRing>());
+    registry.back()->threadId = static_cast<int>(registry.size());
+    owner.ring = registry.back().get();
+    return *owner.ring;
+}
+
+void writeJsonString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') out << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20) out << ' ';
+        else out << c;
+    }
+    out << '"';
+}
+
+} // namespace
+
+int64_t Profiler::now() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::record(const char* name, int64_t startNs, int64_t endNs) {
+    ProfileRing& ring = threadRing();
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    ProfileEvent& event = ring.events[head % kRingSize];
+    event.name.store(name, std::memory_order_relaxed);
+    event.start.store(startNs, std::memory_order_relaxed);
+    event.end.store(endNs, std::memory_order_relaxed);
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::setThreadName(const std::string& name) {
+    ProfileRing& ring = threadRing();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    ring.threadName = name;
+}
+
+void Profiler::clear() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (auto& ring : registry)
+        ring->cleared = ring->head.load(std::memory_order_acquire);
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Failed to write profile: " << path << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << std::fixed << std::setprecision(3);
+    bool first = true;
+    size_t written = 0;
+
+    for (auto& ring : registry) {
+        std::string threadName = ring->threadName.empty()
+            ? "thread " + std::to_string(ring->threadId) : ring->threadName;
+        out << (first ? "" : ",\n")
+            << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->threadId
+            << ",\"args\":{\"name\":";
+        writeJsonString(out, threadName);
+        out << "}}";
+        first = false;
+
+        // The oldest slot is skipped: its owner may be overwriting it right now
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t begin = std::max(ring->cleared.load(), head >= kRingSize ? head - kRingSize + 1 : 0);
+
+        for (uint64_t i = begin; i < head; ++i) {
+            const ProfileEvent& event = ring->events[i % kRingSize];
+            const char* name = event.name.load(std::memory_order_relaxed);
+            int64_t start = event.start.load(std::memory_order_relaxed);
+            int64_t end = event.end.load(std::memory_order_relaxed);
+
+            // The owner may have lapped us while we were reading this slot
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t newest = ring->head.load(std::memory_order_relaxed);
+            if (i + kRingSize <= newest) continue;
+            if (!name) continue;
+
+            out << ",\n{\"name\":";
+            writeJsonString(out, name);
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->threadId
+                << ",\"ts\":" << start / 1000.0
+                << ",\"dur\":" << (end - start) / 1000.0 << "}";
+            ++written;
+        }
+    }
+    out << "\n]}\n";
+
+    std::cout << "Wrote " << written << " profile events to " << path << std::endl;
+    return true;
+}
@@ -1,56 +1,273 @@
 #include "Renderer.h"
+#include "Frustum.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
 
-Renderer::Renderer(Cell& cell, InstanceBuffer& instanceBuffer, Coloring& heatmap)
-    : m_cell(cell), m_instanceBuffer(instanceBuffer), m_heatmap(heatmap)
-{}
+namespace {
 
-void Renderer::render(const Life& life, Shader& shader, const glm::mat4& view, const glm::mat4& projection) {
-    shader.use();
-    shader.setUniform("view", view);
-    shader.setUniform("projection", projection);
+int trailingZeros64(uint64_t v) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(v);
+#else
+    int n = 0;
+    for (; !(v & 1); v >>= 1) ++n;
+    return n;
+#endif
+}
 
-    std::vector<glm::vec3> positions;
-    std::vector<glm::vec3> colors;
+// Fewest bits that hold 0..size-1
+int bitsFor(int size) {
+    int bits = 0;
+    while (bits < 32 && (uint64_t(1) << bits) < uint64_t(size)) ++bits;
+    return bits;
+}
 
+} // namespace
+
+Renderer::Renderer(Cell& cell, InstanceBuffer& instanceBuffer, Coloring& heatmap, Palette& palette)
+    : m_cell(cell), m_instanceBuffer(instanceBuffer), m_heatmap(heatmap), m_palette(palette)
+{}
+
+void Renderer::rebuild(const LifeSnapshot& life, bool gpu) {
     int sizeX = life.getSizeX();
     int sizeY = life.getSizeY();
     int sizeZ = life.getSizeZ();
 
-    for (int z = 0; z < sizeZ; ++z)
-        for (int y = 0; y < sizeY; ++y)
-            for (int x = 0; x < sizeX; ++x) {
-                if (!life.getCell(x, y, z)) continue;
+    m_instances.clear();
+
+    m_bitsX = bitsFor(sizeX);
+    m_bitsY = bitsFor(sizeY);
+    if (m_bitsX + m_bitsY + bitsFor(sizeZ) > 32) {
+        // Cannot happen below 2^32 cells, which the packed grid could not hold anyway
+        std::cerr << "Grid " << sizeX << "x" << sizeY << "x" << sizeZ << " is too large to draw\n";
+        m_instanceCount = 0;
+        ++m_rebuilds;
+        return;
+    }
+
+    if (gpu) {
+        m_gpu->build(life, m_heatmap, m_bitsX, m_bitsY);
+        m_instanceCount = life.getPopulation();
+        ++m_rebuilds;
+        return;
+    }
+
+    // Chunk by chunk, so each chunk's instances are contiguous
+    {
+        PROFILE_ZONE("Renderer::buildInstances");
+        m_chunks.clear();
+        for (int level = 1; level < kLodLevels; ++level) {
+            int side = kInstanceChunk >> level;
+            m_blocks[level].resize(size_t(side) * side * side);
+        }
+
+        int chunksY = (sizeY + kInstanceChunk - 1) / kInstanceChunk;
+        int chunksZ = (sizeZ + kInstanceChunk - 1) / kInstanceChunk;
+        for (int cz = 0; cz < chunksZ; ++cz)
+            for (int cy = 0; cy < chunksY; ++cy)
+                for (int cx = 0; cx < life.getWordsPerRow(); ++cx)
+                    buildChunk(life, cx, cy, cz);
+    }
+
+    // Upload packed instances to GPU
+    {
+        PROFILE_ZONE("InstanceBuffer::upload");
+        m_instanceBuffer.upload(m_instances);
+        m_instanceCount = 0;
+        for (const Chunk& chunk : m_chunks) m_instanceCount += chunk.count[0];
+    }
+
+    ++m_rebuilds;
+}
+
+glm::vec3 Renderer::chunkMin(int cx, int cy, int cz) const {
+    return glm::vec3(cx * kInstanceChunk - m_key.sizeX / 2.0f - 0.5f,
+                     cy * kInstanceChunk - m_key.sizeY / 2.0f - 0.5f,
+                     cz * kInstanceChunk - m_key.sizeZ / 2.0f - 0.5f);
+}
+
+glm::vec3 Renderer::chunkMax(int cx, int cy, int cz) const {
+    return chunkMin(cx + 1, cy + 1, cz + 1);
+}
+
+void Renderer::buildChunk(const LifeSnapshot& life, int cx, int cy, int cz) {
+    const std::vector<uint64_t>& words = life.getWords();
+    const int wordsPerRow = life.getWordsPerRow();
+    const int x0 = cx * kInstanceChunk, y0 = cy * kInstanceChunk, z0 = cz * kInstanceChunk;
+    const int yEnd = std::min(life.getSizeY(), y0 + kInstanceChunk);
+    const int zEnd = std::min(life.getSizeZ(), z0 + kInstanceChunk);
 
-                float offsetX = x - sizeX / 2.0f;
-                float offsetY = y - sizeY / 2.0f;
-                float offsetZ = z - sizeZ / 2.0f;
+    auto pack = [&](int x, int y, int z, uint32_t shade) {
+        PackedInstance instance;
+        instance.cell = uint32_t(uint64_t(x) | uint64_t(y) << m_bitsX | uint64_t(z) << (m_bitsX + m_bitsY));
+        instance.shade = shade;
+        m_instances.push_back(instance);
+    };
 
-                positions.emplace_back(offsetX, offsetY, offsetZ);
+    Chunk chunk;
+    chunk.min = glm::vec3(x0 - life.getSizeX() / 2.0f - 0.5f, y0 - life.getSizeY() / 2.0f - 0.5f,
+                          z0 - life.getSizeZ() / 2.0f - 0.5f);
+    chunk.max = chunk.min + glm::vec3(float(kInstanceChunk));
+    chunk.first[0] = uint32_t(m_instances.size());
 
-                Color c = m_heatmap.getColor(life, x, y, z);
-                colors.emplace_back(c.r, c.g, c.b);
+    // Each live cell is shaded and packed as the bit scan finds it
+    {
+        PROFILE_ZONE("Renderer::buildChunk");
+        for (int z = z0; z < zEnd; ++z)
+            for (int y = y0; y < yEnd; ++y) {
+                uint64_t bits = words[(size_t(z) * life.getSizeY() + y) * wordsPerRow + cx];
+                for (; bits; bits &= bits - 1) {
+                    int x = x0 + trailingZeros64(bits);
+                    uint32_t shade = m_heatmap.getShade(life, x, y, z);
+                    pack(x, y, z, shade);
+
+                    for (int level = 1; level < kLodLevels; ++level) {
+                        int side = kInstanceChunk >> level;
+                        uint32_t index = uint32_t((((z - z0) >> level) * side + ((y - y0) >> level)) * side +
+                                                  ((x - x0) >> level));
+                        Block& block = m_blocks[level][index];
+                        if (block.cells++ == 0) m_touched[level].push_back(index);
+                        block.shades += shade;
+                    }
+                }
             }
+    }
+    if (m_instances.size() == chunk.first[0]) return;
+    chunk.count[0] = uint32_t(m_instances.size()) - chunk.first[0];
+
+    // A block is drawn if any of its cells is alive, in their mean shade
+    for (int level = 1; level < kLodLevels; ++level) {
+        int side = kInstanceChunk >> level;
+        chunk.first[level] = uint32_t(m_instances.size());
+        for (uint32_t index : m_touched[level]) {
+            Block& block = m_blocks[level][index];
+            pack((x0 >> level) + int(index % side), (y0 >> level) + int(index / side % side),
+                 (z0 >> level) + int(index / side / side), (block.shades + block.cells / 2) / block.cells);
+            block = Block();
+        }
+        m_touched[level].clear();
+        chunk.count[level] = uint32_t(m_instances.size()) - chunk.first[level];
+    }
+
+    m_chunks.push_back(chunk);
+}
+
+int Renderer::levelFor(const Chunk& chunk, const glm::vec3& eye, const glm::mat4& projection) const {
+    if (m_viewportHeight <= 0) return 0;
+
+    // Distance from the eye to the nearest point of the chunk
+    float d2 = 0;
+    for (int i = 0; i < 3; ++i) {
+        float out = std::max({ chunk.min[i] - eye[i], 0.0f, eye[i] - chunk.max[i] });
+        d2 += out * out;
+    }
+    if (d2 < 1.0f) return 0;
+
+    // On-screen height of one cell there
+    float pixels = projection[1][1] * 0.5f * float(m_viewportHeight) / std::sqrt(d2);
+    int level = 0;
+    while (level + 1 < kLodLevels && pixels * float(1 << level) < kLodMinPixels) ++level;
+    return level;
+}
+
+void Renderer::render(const LifeSnapshot& life, Shader& shader, const glm::mat4& view, const glm::mat4& projection) {
+    PROFILE_ZONE("Renderer::render");
+
+    CacheKey key;
+    key.revision = life.getRevision();
+    key.generation = life.getGeneration();
+    key.sizeX = life.getSizeX();
+    key.sizeY = life.getSizeY();
+    key.sizeZ = life.getSizeZ();
+    key.toric = life.isToric();
+    key.byDepth = Coloring::shadesByDepth(m_heatmap.getPattern());
+    key.gpu = m_useGpu && m_gpu && m_gpu->isReady();
 
-    if (positions.empty()) return;
+    if (!m_valid || !(key == m_key)) {
+        rebuild(life, key.gpu);
+        m_key = key;
+        m_valid = true;
+    }
 
-    // Upload positions and colors to GPU
-    m_instanceBuffer.uploadPositions(positions);
-    m_instanceBuffer.uploadColors(colors);
+    if (m_instanceCount == 0) return;
+
+    shader.use();
+    shader.setUniform("view", view);
+    shader.setUniform("projection", projection);
+    shader.setUniform("bitsX", m_bitsX);
+    shader.setUniform("bitsY", m_bitsY);
+    shader.setUniform("gridOrigin", glm::vec3(key.sizeX, key.sizeY, key.sizeZ) * -0.5f);
+    shader.setUniform("cellScale", 1);
+    shader.setUniform("palette", 0);
+    m_palette.bind(0);
 
     // Bind cell VAO and setup instanced attributes
     m_cell.bind();
 
+    GLintptr offset = key.gpu ? 0 : m_instanceBuffer.getOffset();
+    glBindBuffer(GL_ARRAY_BUFFER, key.gpu ? m_gpu->getInstanceVBO() : m_instanceBuffer.getVBO());
+
     glEnableVertexAttribArray(2);
-    glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer.getPositionVBO());
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+    glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, sizeof(PackedInstance),
+                           (void*)(offset + offsetof(PackedInstance, cell)));
     glVertexAttribDivisor(2, 1);
 
     glEnableVertexAttribArray(3);
-    glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer.getColorVBO());
-    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+    glVertexAttribIPointer(3, 1, GL_UNSIGNED_BYTE, sizeof(PackedInstance),
+                           (void*)(offset + offsetof(PackedInstance, shade)));
     glVertexAttribDivisor(3, 1);
 
-    glDrawElementsInstanced(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0, positions.size());
+    PROFILE_ZONE("Renderer::draw");
+    Frustum frustum(projection * view);
+    glm::vec4 eye4 = glm::inverse(view)[3];
+    glm::vec3 eye(eye4.x, eye4.y, eye4.z);
+    m_culledChunks = 0;
+    m_drawnInstances = 0;
+
+    if (key.gpu) {
+        // Consecutive visible chunks go out as one multi-draw of their commands
+        const GLsizei commandSize = 5 * sizeof(GLuint);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_gpu->getCommandBuffer());
+        GLsizei first = 0, run = 0;
+        auto flush = [&]() {
+            if (run) glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(GLintptr(first) * commandSize), run, 0);
+            run = 0;
+        };
+        GLsizei index = 0;
+        for (int cz = 0; cz < m_gpu->getChunksZ(); ++cz)
+            for (int cy = 0; cy < m_gpu->getChunksY(); ++cy)
+                for (int cx = 0; cx < m_gpu->getChunksX(); ++cx, ++index) {
+                    if (!frustum.intersects(chunkMin(cx, cy, cz), chunkMax(cx, cy, cz))) {
+                        ++m_culledChunks;
+                        flush();
+                        continue;
+                    }
+                    if (!run) first = index;
+                    ++run;
+                }
+        flush();
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    } else {
+        int scale = 1;
+        for (const Chunk& chunk : m_chunks) {
+            if (!frustum.intersects(chunk.min, chunk.max)) {
+                ++m_culledChunks;
+                continue;
+            }
+            int level = levelFor(chunk, eye, projection);
+            if ((1 << level) != scale) {
+                scale = 1 << level;
+                shader.setUniform("cellScale", scale);
+            }
+            glDrawElementsInstancedBaseInstance(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0,
+                                                GLsizei(chunk.count[level]), chunk.first[level]);
+            m_drawnInstances += chunk.count[level];
+        }
+        m_instanceBuffer.fence();
+    }
 
     glBindVertexArray(0);
-}
\ No newline at end of file
+}
@@ -82,6 +82,38 @@ bool Shader::loadFromFile(const std::string& vertexPath, const std::string& frag
     return m_program != 0;
 }
 
+bool Shader::loadComputeFromFile(const std::string& computePath) {
+    std::string computeSource = readFile(computePath);
+    if (computeSource.empty()) {
+        std::cerr << "Failed to read shader file: " << computePath << std::endl;
+        return false;
+    }
+
+    GLuint computeShader = compileShader(computeSource, GL_COMPUTE_SHADER);
+    if (!computeShader) {
+        std::cerr << "Failed to compile " << computePath << std::endl;
+        return false;
+    }
+
+    if (m_program) glDeleteProgram(m_program);
+    m_program = glCreateProgram();
+    glAttachShader(m_program, computeShader);
+    glLinkProgram(m_program);
+
+    GLint success;
+    glGetProgramiv(m_program, GL_LINK_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetProgramInfoLog(m_program, 512, nullptr, infoLog);
+        std::cerr << "Shader program linking failed:\n" << infoLog << std::endl;
+        glDeleteProgram(m_program);
+        m_program = 0;
+    }
+
+    glDeleteShader(computeShader);
+    return m_program != 0;
+}
+
 void Shader::use() {
     glUseProgram(m_program);
 }
@@ -0,0 +1,177 @@
+#include "Simulation.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+
+Simulation::Simulation(Life& life)
+    : m_life(life)
+{
+    publish();
+}
+
+Simulation::~Simulation() {
+    stop();
+}
+
+void Simulation::start() {
+    if (m_running) return;
+    m_running = true;
+    m_thread = std::thread(&Simulation::run, this);
+}
+
+void Simulation::stop() {
+    m_running = false;
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void Simulation::post(Command command) {
+    m_commands.push(std::move(command));
+    ++m_posted;
+}
+
+void Simulation::waitForCommands() {
+    long long target = m_posted;
+    while (m_applied < target && m_running)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+void Simulation::setGenerationCallback(std::function<void(Life&)> callback) {
+    m_onGeneration = std::move(callback);
+}
+
+void Simulation::setStepFunction(std::function<void(Life&)> stepFunction) {
+    m_stepFunction = std::move(stepFunction);
+}
+
+// Simulation thread only (or before start())
+void Simulation::publish() {
+    PROFILE_ZONE("Simulation::publish");
+    m_life.snapshot(m_snapshots.back());
+    m_snapshots.publish();
+}
+
+void Simulation::apply(Command& command) {
+    switch (command.type) {
+        case CommandType::Clear:     m_life.clear(); break;
+        case CommandType::Randomize: m_life.randomize(); break;
+        case CommandType::Step:      advance(); break;
+        case CommandType::SetMode:   m_life.setMode(command.mode); break;
+        case CommandType::SetToric:  m_life.setToric(command.toric); break;
+        case CommandType::SetEngine: m_life.setEngine(command.engine); break;
+        case CommandType::SetCells:  m_life.setCells(command.cells); break;
+        case CommandType::Apply:     if (command.apply) command.apply(m_life); break;
+    }
+}
+
+// Applies every queued command; runs of SetCells are merged into a single
+// batch. Returns true if anything was applied.
+bool Simulation::drainCommands() {
+    PROFILE_ZONE("Simulation::drainCommands");
+    Command command;
+    std::vector<CellEdit> edits;
+    long long applied = 0;
+
+    while (m_commands.pop(command)) {
+        ++applied;
+        if (command.type == CommandType::SetCells) {
+            if (edits.empty()) edits.swap(command.cells);
+            else edits.insert(edits.end(), command.cells.begin(), command.cells.end());
+            continue;
+        }
+        if (!edits.empty()) {
+            m_life.setCells(edits);
+            edits.clear();
+        }
+        apply(command);
+    }
+    if (!edits.empty()) m_life.setCells(edits);
+
+    if (applied == 0) return false;
+    publish();
+    m_applied += applied;
+    return true;
+}
+
+void Simulation::advance() {
+    if (m_stepFunction) m_stepFunction(m_life);
+    else m_life.update();
+}
+
+void Simulation::step() {
+    PROFILE_ZONE("Simulation::step");
+    advance();
+    if (m_onGeneration) {
+        PROFILE_ZONE("Simulation::onGeneration");
+        m_onGeneration(m_life);
+    }
+}
+
+void Simulation::run() {
+    PROFILE_THREAD("simulation");
+
+    using Clock = std::chrono::steady_clock;
+    const float publishInterval = 1.f / 120.f; // max throughput: display rate is enough
+    const float rateWindow = 0.5f;
+
+    auto lastUpdate = Clock::now();
+    auto lastPublish = lastUpdate;
+    auto rateStart = lastUpdate;
+    long long rateGenerations = 0;
+    bool unpublished = false;
+
+    auto seconds = [](Clock::duration d) { return std::chrono::duration<float>(d).count(); };
+
+    while (m_running) {
+        auto now = Clock::now();
+        float window = seconds(now - rateStart);
+        if (window >= rateWindow) {
+            m_generationsPerSecond = rateGenerations / window;
+            rateGenerations = 0;
+            rateStart = now;
+        }
+
+        drainCommands();
+
+        if (m_maxThroughput) {
+            step();
+            ++rateGenerations;
+            unpublished = true;
+            if (seconds(Clock::now() - lastPublish) >= publishInterval) {
+                publish();
+                unpublished = false;
+                lastPublish = Clock::now();
+            }
+            lastUpdate = Clock::now();
+            continue;
+        }
+
+        if (unpublished) {
+            publish();
+            unpublished = false;
+        }
+
+        float speed = m_speed;
+        if (speed <= 0.f) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            lastUpdate = Clock::now();
+            continue;
+        }
+
+        float interval = m_updateInterval / speed;
+        float elapsed = seconds(Clock::now() - lastUpdate);
+        if (elapsed < interval) {
+            // Short naps so commands, speed changes and stop() are picked up promptly
+            float remaining = std::min(interval - elapsed, 0.005f);
+            std::this_thread::sleep_for(std::chrono::duration<float>(remaining));
+            continue;
+        }
+        lastUpdate = Clock::now();
+
+        step();
+        ++rateGenerations;
+        publish();
+    }
+
+    drainCommands();
+    publish();
+}
@@ -0,0 +1,232 @@
+#include "VolumeRenderer.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+int ceilPow2(int v) {
+    int p = 1;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+} // namespace
+
+VolumeRenderer::VolumeRenderer(Coloring& coloring, Palette& palette)
+    : m_coloring(coloring), m_palette(palette)
+{
+    glGenVertexArrays(1, &m_vao);
+}
+
+VolumeRenderer::~VolumeRenderer() {
+    releaseTextures();
+    if (m_vao) glDeleteVertexArrays(1, &m_vao);
+}
+
+void VolumeRenderer::releaseTextures() {
+    if (m_cells) glDeleteTextures(1, &m_cells);
+    if (m_occupancy) glDeleteTextures(1, &m_occupancy);
+    m_cells = m_occupancy = 0;
+    m_levels.clear();
+}
+
+void VolumeRenderer::reset(const LifeSnapshot& life) {
+    releaseTextures();
+    m_sizeX = life.getSizeX();
+    m_sizeY = life.getSizeY();
+    m_sizeZ = life.getSizeZ();
+    m_wordsPerRow = life.getWordsPerRow();
+    m_valid = true;
+
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_3D_TEXTURE_SIZE, &maxSize);
+    m_tooLarge = m_wordsPerRow * 2 > maxSize || m_sizeY > maxSize || m_sizeZ > maxSize;
+    if (m_tooLarge) {
+        std::cerr << "Grid is too large for a 3D texture (limit " << maxSize << "), volume rendering disabled.\n";
+        return;
+    }
+
+    // Two 32-bit texels per packed word; the padding bits are always clear
+    glGenTextures(1, &m_cells);
+    glBindTexture(GL_TEXTURE_3D, m_cells);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_R32UI, m_wordsPerRow * 2, m_sizeY, m_sizeZ, 0,
+                 GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+    // Power-of-two brick counts so every texel of a level covers exactly
+    // 2x2x2 texels of the one below, down to a single texel
+    Level bricks;
+    bricks.sizeX = ceilPow2((m_sizeX + kBrick - 1) / kBrick);
+    bricks.sizeY = ceilPow2((m_sizeY + kBrick - 1) / kBrick);
+    bricks.sizeZ = ceilPow2((m_sizeZ + kBrick - 1) / kBrick);
+    m_levels.push_back(bricks);
+    while (m_levels.back().sizeX > 1 || m_levels.back().sizeY > 1 || m_levels.back().sizeZ > 1) {
+        const Level& below = m_levels.back();
+        Level level;
+        level.sizeX = std::max(1, below.sizeX / 2);
+        level.sizeY = std::max(1, below.sizeY / 2);
+        level.sizeZ = std::max(1, below.sizeZ / 2);
+        m_levels.push_back(level);
+    }
+
+    glGenTextures(1, &m_occupancy);
+    glBindTexture(GL_TEXTURE_3D, m_occupancy);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAX_LEVEL, GLint(m_levels.size()) - 1);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (size_t i = 0; i < m_levels.size(); ++i) {
+        Level& level = m_levels[i];
+        level.texels.assign(size_t(level.sizeX) * level.sizeY * level.sizeZ, 0);
+        glTexImage3D(GL_TEXTURE_3D, GLint(i), GL_R8UI, level.sizeX, level.sizeY, level.sizeZ, 0,
+                     GL_RED_INTEGER, GL_UNSIGNED_BYTE, level.texels.data());
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_3D, 0);
+
+    int lastBrickZ = (m_sizeZ - 1) / kBrick;
+    uploadSlices(life, 0, m_sizeZ - 1);
+    countBricks(life, 0, lastBrickZ);
+    buildLevels(0, lastBrickZ);
+    m_previous = life.getWords();
+}
+
+void VolumeRenderer::update(const LifeSnapshot& life) {
+    PROFILE_ZONE("VolumeRenderer::diff");
+    const std::vector<uint64_t>& words = life.getWords();
+    const size_t slice = size_t(m_sizeY) * m_wordsPerRow;
+
+    int z0 = m_sizeZ, z1 = -1;
+    for (int z = 0; z < m_sizeZ; ++z) {
+        auto first = words.begin() + z * slice;
+        if (!std::equal(first, first + slice, m_previous.begin() + z * slice)) {
+            z0 = std::min(z0, z);
+            z1 = z;
+        }
+    }
+    if (z1 < 0) return;
+
+    uploadSlices(life, z0, z1);
+    countBricks(life, z0 / kBrick, z1 / kBrick);
+    buildLevels(z0 / kBrick, z1 / kBrick);
+    std::copy(words.begin() + z0 * slice, words.begin() + (z1 + 1) * slice, m_previous.begin() + z0 * slice);
+}
+
+void VolumeRenderer::uploadSlices(const LifeSnapshot& life, int z0, int z1) {
+    PROFILE_ZONE("VolumeRenderer::upload");
+    const uint64_t* first = life.getWords().data() + size_t(z0) * m_sizeY * m_wordsPerRow;
+    glBindTexture(GL_TEXTURE_3D, m_cells);
+    glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, z0, m_wordsPerRow * 2, m_sizeY, z1 - z0 + 1,
+                    GL_RED_INTEGER, GL_UNSIGNED_INT, first);
+    glBindTexture(GL_TEXTURE_3D, 0);
+    m_uploadedSlices += uint64_t(z1 - z0 + 1);
+}
+
+void VolumeRenderer::countBricks(const LifeSnapshot& life, int bz0, int bz1) {
+    PROFILE_ZONE("VolumeRenderer::bricks");
+    const std::vector<uint64_t>& words = life.getWords();
+    Level& bricks = m_levels[0];
+    const size_t plane = size_t(bricks.sizeX) * bricks.sizeY;
+    std::fill(bricks.texels.begin() + bz0 * plane, bricks.texels.begin() + (bz1 + 1) * plane, 0);
+
+    // kBrick is 8: each byte of a packed word is the x extent of one brick
+    int zEnd = std::min(m_sizeZ, (bz1 + 1) * kBrick);
+    for (int z = bz0 * kBrick; z < zEnd; ++z)
+        for (int y = 0; y < m_sizeY; ++y) {
+            const uint64_t* row = words.data() + (size_t(z) * m_sizeY + y) * m_wordsPerRow;
+            uint8_t* texels = bricks.texels.data() + (size_t(z / kBrick) * bricks.sizeY + y / kBrick) * bricks.sizeX;
+            for (int w = 0; w < m_wordsPerRow; ++w) {
+                uint64_t bits = row[w];
+                for (int b = 0; bits; ++b, bits >>= 8)
+                    if (bits & 0xFF) texels[w * 8 + b] = 1;
+            }
+        }
+}
+
+void VolumeRenderer::buildLevels(int bz0, int bz1) {
+    PROFILE_ZONE("VolumeRenderer::levels");
+    glBindTexture(GL_TEXTURE_3D, m_occupancy);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (size_t i = 0; i < m_levels.size(); ++i) {
+        Level& level = m_levels[i];
+        int z0 = bz0 >> i, z1 = std::min(bz1 >> i, level.sizeZ - 1);
+        const size_t plane = size_t(level.sizeX) * level.sizeY;
+
+        if (i > 0) {
+            const Level& below = m_levels[i - 1];
+            for (int z = z0; z <= z1; ++z)
+                for (int y = 0; y < level.sizeY; ++y)
+                    for (int x = 0; x < level.sizeX; ++x) {
+                        uint8_t any = 0;
+                        for (int cz = z * 2; cz < std::min(z * 2 + 2, below.sizeZ); ++cz)
+                            for (int cy = y * 2; cy < std::min(y * 2 + 2, below.sizeY); ++cy)
+                                for (int cx = x * 2; cx < std::min(x * 2 + 2, below.sizeX); ++cx)
+                                    any |= below.texels[(size_t(cz) * below.sizeY + cy) * below.sizeX + cx];
+                        level.texels[(size_t(z) * level.sizeY + y) * level.sizeX + x] = any;
+                    }
+        }
+
+        glTexSubImage3D(GL_TEXTURE_3D, GLint(i), 0, 0, z0, level.sizeX, level.sizeY, z1 - z0 + 1,
+                        GL_RED_INTEGER, GL_UNSIGNED_BYTE, level.texels.data() + z0 * plane);
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_3D, 0);
+}
+
+void VolumeRenderer::render(const LifeSnapshot& life, Shader& shader, const glm::mat4& view, const glm::mat4& projection) {
+    PROFILE_ZONE("VolumeRenderer::render");
+
+    bool reshaped = !m_valid || life.getSizeX() != m_sizeX || life.getSizeY() != m_sizeY ||
+                    life.getSizeZ() != m_sizeZ;
+    if (reshaped)
+        reset(life);
+    else if (!m_tooLarge && (life.getRevision() != m_revision || life.getGeneration() != m_generation))
+        update(life);
+    m_revision = life.getRevision();
+    m_generation = life.getGeneration();
+    if (m_tooLarge) return;
+
+    glm::mat4 viewProjection = projection * view;
+    shader.use();
+    shader.setUniform("viewProjection", viewProjection);
+    shader.setUniform("inverseViewProjection", glm::inverse(viewProjection));
+    // Grid coordinates put cell x at [x, x + 1); the cubes are centered on x - size / 2
+    shader.setUniform("gridOrigin", glm::vec3(-m_sizeX / 2.0f - 0.5f, -m_sizeY / 2.0f - 0.5f, -m_sizeZ / 2.0f - 0.5f));
+    shader.setUniform("sizeX", m_sizeX);
+    shader.setUniform("sizeY", m_sizeY);
+    shader.setUniform("sizeZ", m_sizeZ);
+    shader.setUniform("toric", life.isToric() ? 1 : 0);
+    shader.setUniform("radius", m_coloring.getRadius());
+    shader.setUniform("byDepth", Coloring::shadesByDepth(m_coloring.getPattern()) ? 1 : 0);
+    shader.setUniform("maxDensity", Coloring::kMaxDensity);
+    shader.setUniform("brick", kBrick);
+    shader.setUniform("topLevel", int(m_levels.size()) - 1);
+    shader.setUniform("maxSteps", 4 * (m_sizeX + m_sizeY + m_sizeZ) + 64);
+    shader.setUniform("palette", 0);
+    shader.setUniform("cells", 1);
+    shader.setUniform("occupancy", 2);
+
+    m_palette.bind(0);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_3D, m_cells);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_3D, m_occupancy);
+
+    PROFILE_ZONE("VolumeRenderer::draw");
+    glBindVertexArray(m_vao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_3D, 0);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_3D, 0);
+    glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,56 @@
+#include "WorkerPool.h"
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (auto& t : m_threads) t.join();
+}
+
+void WorkerPool::run(int workers, const std::function<void()>& task) {
+    if (workers <= 1) {
+        task();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // New threads wait for the round after the current one
+        while (int(m_threads.size()) < workers - 1)
+            m_threads.emplace_back(&WorkerPool::work, this, int(m_threads.size()), m_round);
+        m_task = &task;
+        m_helpers = workers - 1;
+        m_pending = workers - 1;
+        ++m_round;
+    }
+    m_wake.notify_all();
+
+    task();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [&] { return m_pending == 0; });
+    m_task = nullptr;
+}
+
+int WorkerPool::getThreadCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return int(m_threads.size());
+}
+
+void WorkerPool::work(int index, uint64_t round) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_wake.wait(lock, [&] { return m_stopping || m_round != round; });
+        if (m_stopping) return;
+        round = m_round;
+        if (index >= m_helpers) continue;
+
+        const std::function<void()>* task = m_task;
+        lock.unlock();
+        (*task)();
+        lock.lock();
+        if (--m_pending == 0) m_done.notify_one();
+    }
+}
@@ -0,0 +1,350 @@
+// life-run: headless batch runner. Loads IO/<name>/initial.txt (or an RLE
+// file), runs N generations and writes the final state plus a throughput
+// report. Links only the simulation core, no SFML or OpenGL.
+
+#include "Life.h"
+#include "Autotuner.h"
+#include "AsyncLogWriter.h"
+#include "LogReplay.h"
+#include "Checkpoint.h"
+
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace {
+
+void printUsage() {
+    std::cout <<
+        "Usage: life-run <pattern> [options]\n"
+        "  Loads IO/<pattern>/initial.txt, or <pattern> itself if it ends in .rle,\n"
+        "  and runs it without a window.\n"
+        "\n"
+        "Options:\n"
+        "  --generations N     Number of generations to run (default 100).\n"
+        "  --rule NAME         Conway3D, Conway2D, Custom3D or Custom2D (default Conway3D,\n"
+        "                      or the rule of an RLE pattern).\n"
+        "  --engine NAME       dense, bitsliced, sparse or auto (default auto).\n"
+        "  --threads N         Worker threads (default: machine profile or 1).\n"
+        "  --toric             Wrap around the grid edges (also set by an RLE \":T\" rule).\n"
+        "  --out FILE          Final state file (default IO/<pattern>/final.txt);\n"
+        "                      a .lifb extension writes a binary snapshot, .rle an RLE file.\n"
+        "  --report FILE       Also write the throughput report to FILE.\n"
+        "  --log FILE          Record every generation in a delta-encoded log.\n"
+        "  --keyframe N        Full frame every N generations in the log (default 64).\n"
+        "  --checkpoint FILE   Save the whole run to FILE atomically, periodically and at the end.\n"
+        "  --checkpoint-every N  Generations between checkpoints (default 1000, 0: only at the end).\n"
+        "  --resume FILE       Continue from a checkpoint instead of loading <pattern>.\n"
+        "  --profile FILE      Tuning profile to load (default profiles/<host>.profile).\n"
+        "  --autotune          Tune for the loaded grid size and save the machine profile first.\n"
+        "  --help              Show this message.\n"
+        "\n"
+        "Replay: life-run --replay <log.lifl> [--seek G] [--generations N] [--backward]\n"
+        "  Plays a generation log instead of simulating: seeks to generation G (default:\n"
+        "  the first logged one), then plays N frames (default: to the end of the log)\n"
+        "  forward or backward. --out and --report work as above.\n";
+}
+
+// The whole of text as a decimal number in minimum..maximum
+bool parseNumber(const std::string& text, long long minimum, long long maximum, long long& number) {
+    const char* start = text.c_str();
+    char* stop = nullptr;
+    errno = 0;
+    long long parsed = std::strtoll(start, &stop, 10);
+    if (stop == start || *stop != '\0' || errno == ERANGE || parsed < minimum || parsed > maximum)
+        return false;
+    number = parsed;
+    return true;
+}
+
+// Final state in the format its extension asks for
+bool saveState(const Life& life, const std::string& path, const std::string& name) {
+    std::string extension = std::filesystem::path(path).extension().string();
+    if (extension == ".lifb") return life.saveBinary(path);
+    if (extension == ".rle") return life.saveRLE(path, name);
+    return life.exportToFile(path, name);
+}
+
+bool writeReport(const std::string& report, const std::string& path) {
+    std::cout << report;
+    if (path.empty()) return true;
+
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Failed to write report: " << path << std::endl;
+        return false;
+    }
+    out << report;
+    return true;
+}
+
+int runReplay(const std::string& logPath, bool seekGiven, long long seekGeneration, long long frames,
+              bool backward, const std::string& outPath, const std::string& reportPath) {
+    using Clock = std::chrono::steady_clock;
+    auto seconds = [](Clock::duration d) { return std::chrono::duration<double>(d).count(); };
+
+    auto opened = Clock::now();
+    LogReplay replay;
+    if (!replay.open(logPath))
+        return 1;
+    double openSeconds = seconds(Clock::now() - opened);
+
+    Life life(1, 1, 1);
+    auto seekStart = Clock::now();
+    if (!replay.seek(seekGiven ? seekGeneration : replay.getFirstGeneration(), life))
+        return 1;
+    double seekSeconds = seconds(Clock::now() - seekStart);
+
+    std::cout << "Replaying " << logPath << " (" << replay.getFrameCount() << " frames, generations "
+              << replay.getFirstGeneration() << " to " << replay.getLastGeneration() << ") "
+              << (backward ? "backward" : "forward") << " from generation " << replay.getGeneration()
+              << std::endl;
+
+    replay.setForward(!backward);
+    long long played = 0;
+    auto playStart = Clock::now();
+    while ((frames < 0 || played < frames) && replay.step(life))
+        ++played;
+    double playSeconds = seconds(Clock::now() - playStart);
+
+    std::string name = std::filesystem::path(logPath).stem().string();
+    if (!outPath.empty() && !saveState(life, outPath, name))
+        return 1;
+
+    std::ostringstream report;
+    report << "log=" << logPath << "\n"
+           << "size=" << life.getSizeX() << "x" << life.getSizeY() << "x" << life.getSizeZ() << "\n"
+           << "frames=" << replay.getFrameCount() << "\n"
+           << "keyframeInterval=" << replay.getReader().getKeyframeInterval() << "\n"
+           << "indexed=" << (replay.getReader().usedIndex() ? 1 : 0) << "\n"
+           << "openSeconds=" << std::setprecision(6) << openSeconds << "\n"
+           << "seekSeconds=" << seekSeconds << "\n"
+           << "direction=" << (backward ? "backward" : "forward") << "\n"
+           << "framesPlayed=" << played << "\n"
+           << "playSeconds=" << playSeconds << "\n"
+           << "framesPerSecond=" << (playSeconds > 0.0 ? played / playSeconds : 0.0) << "\n"
+           << "generation=" << life.getGeneration() << "\n"
+           << "rule=" << Life::modeName(life.getMode()) << "\n"
+           << "population=" << life.getPopulation() << "\n";
+    if (!outPath.empty())
+        report << "finalState=" << outPath << "\n";
+
+    return writeReport(report.str(), reportPath) ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string pattern;
+    long long generations = 100;
+    bool generationsGiven = false;
+    bool replayMode = false, seekGiven = false, backward = false;
+    long long seekGeneration = 0;
+    LifeMode mode = LifeMode::Current3D;
+    bool ruleGiven = false;
+    LifeEngine engine = LifeEngine::Auto;
+    bool engineGiven = false;
+    int threads = 0;
+    bool toric = false;
+    bool autotune = false;
+    std::string outPath, reportPath, logPath;
+    int keyframeInterval = 64;
+    std::string checkpointPath, resumePath;
+    long long checkpointEvery = 1000;
+    std::string profilePath = Life::machineProfilePath();
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << "\n";
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        auto number = [&](long long minimum, long long maximum) -> long long {
+            std::string text = value();
+            long long parsed = 0;
+            if (!parseNumber(text, minimum, maximum, parsed)) {
+                std::cerr << "Invalid value for " << arg << ": " << text << "\n";
+                printUsage();
+                std::exit(2);
+            }
+            return parsed;
+        };
+
+        if (arg == "--help" || arg == "-h") { printUsage(); return 0; }
+        else if (arg == "--generations") { generations = number(0, LLONG_MAX); generationsGiven = true; }
+        else if (arg == "--replay") replayMode = true;
+        else if (arg == "--seek") { seekGeneration = number(0, LLONG_MAX); seekGiven = true; }
+        else if (arg == "--backward") backward = true;
+        else if (arg == "--threads") threads = int(number(0, INT_MAX));
+        else if (arg == "--toric") toric = true;
+        else if (arg == "--out") outPath = value();
+        else if (arg == "--report") reportPath = value();
+        else if (arg == "--log") logPath = value();
+        else if (arg == "--keyframe") keyframeInterval = int(number(1, INT_MAX));
+        else if (arg == "--checkpoint") checkpointPath = value();
+        else if (arg == "--checkpoint-every") checkpointEvery = number(0, LLONG_MAX);
+        else if (arg == "--resume") resumePath = value();
+        else if (arg == "--profile") profilePath = value();
+        else if (arg == "--autotune") autotune = true;
+        else if (arg == "--rule") {
+            std::string name = value();
+            if (!Life::parseMode(name, mode)) {
+                std::cerr << "Unknown rule: " << name << "\n";
+                return 2;
+            }
+            ruleGiven = true;
+        }
+        else if (arg == "--engine") {
+            std::string name = value();
+            if (!Life::parseEngine(name, engine)) {
+                std::cerr << "Unknown engine: " << name << "\n";
+                return 2;
+            }
+            engineGiven = true;
+        }
+        else if (!arg.empty() && arg[0] != '-' && pattern.empty()) pattern = arg;
+        else {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (pattern.empty() && resumePath.empty()) {
+        printUsage();
+        return 2;
+    }
+
+    if (replayMode)
+        return runReplay(pattern, seekGiven, seekGeneration, generationsGiven ? generations : -1,
+                         backward, outPath, reportPath);
+
+    Life life(1, 1, 1);
+    bool rleInput = std::filesystem::path(pattern).extension() == ".rle";
+    if (!resumePath.empty()) {
+        // The checkpoint's rule, boundary and engine apply unless overridden
+        Checkpoint checkpoint;
+        if (!checkpoint.load(resumePath) || !checkpoint.restore(life))
+            return 1;
+        if (!ruleGiven) mode = life.getMode();
+        if (!engineGiven) engine = life.getEngine();
+        toric = toric || life.isToric();
+        pattern = checkpoint.name;
+        std::cout << "Resuming '" << pattern << "' at generation " << life.getGeneration()
+                  << " from " << resumePath << std::endl;
+    }
+    else if (!(rleInput ? life.loadRLE(pattern) : life.loadFromFile(pattern)))
+        return 1;
+    if (rleInput && resumePath.empty()) {
+        // The file's rule and boundary apply unless overridden
+        if (!ruleGiven) mode = life.getMode();
+        toric = toric || life.isToric();
+        pattern = std::filesystem::path(pattern).stem().string();
+    }
+
+    if (autotune) {
+        Autotuner tuner(life.getSizeX(), life.getSizeY(), life.getSizeZ());
+        tuner.run();
+        tuner.saveProfile(profilePath);
+    }
+    life.loadProfile(profilePath);
+
+    life.setMode(mode);
+    life.setToric(toric);
+    life.setEngine(engine);
+    if (threads > 0) life.setThreadCount(threads);
+
+    std::cout << "Running " << generations << " generations of " << Life::modeName(mode)
+              << " with engine " << Life::engineName(engine) << " on "
+              << life.getThreadCount() << " thread(s)..." << std::endl;
+
+    // Logging overlaps with the simulation; Block keeps every generation
+    AsyncLogWriter log(16, LogFullPolicy::Block);
+    auto logGeneration = [&]() {
+        auto snapshot = std::make_shared<LifeSnapshot>();
+        life.snapshot(*snapshot);
+        log.submit(std::move(snapshot));
+    };
+    if (!logPath.empty()) {
+        if (!log.open(logPath, life.getSizeX(), life.getSizeY(), life.getSizeZ(), keyframeInterval))
+            return 1;
+        logGeneration();
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    auto lastProgress = start;
+
+    // Checkpoints are saved on their own thread from a copy of the grid
+    CheckpointWriter checkpoints;
+    for (long long g = 0; g < generations; ++g) {
+        life.update();
+        if (log.isOpen()) logGeneration();
+        if (!checkpointPath.empty() && checkpointEvery > 0 && life.getGeneration() % checkpointEvery == 0)
+            checkpoints.submit(Checkpoint::capture(life, pattern, ViewState()), checkpointPath);
+
+        auto now = Clock::now();
+        if (now - lastProgress >= std::chrono::seconds(1)) {
+            double elapsed = std::chrono::duration<double>(now - start).count();
+            std::cout << "  generation " << (g + 1) << "/" << generations
+                      << " (" << (g + 1) / elapsed << " gen/s)" << std::endl;
+            lastProgress = now;
+        }
+    }
+
+    log.flush();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (!checkpointPath.empty()) {
+        checkpoints.submit(Checkpoint::capture(life, pattern, ViewState()), checkpointPath);
+        checkpoints.flush();
+        if (checkpoints.getFailed() > 0) {
+            std::cerr << checkpoints.getFailed() << " checkpoint(s) could not be written to " << checkpointPath << "\n";
+            return 1;
+        }
+    }
+    double cells = double(life.getSizeX()) * life.getSizeY() * life.getSizeZ();
+    double genPerSecond = seconds > 0.0 ? generations / seconds : 0.0;
+
+    if (outPath.empty()) outPath = "IO/" + pattern + "/final.txt";
+    if (!saveState(life, outPath, pattern))
+        return 1;
+
+    std::ostringstream report;
+    report << "pattern=" << pattern << "\n"
+           << "size=" << life.getSizeX() << "x" << life.getSizeY() << "x" << life.getSizeZ() << "\n"
+           << "rule=" << Life::modeName(mode) << "\n"
+           << "toric=" << (toric ? 1 : 0) << "\n"
+           << "engine=" << Life::engineName(engine) << "\n"
+           << "finalEngine=" << Life::engineName(life.getActiveEngine()) << "\n"
+           << "engineSwitches=" << life.getEngineHistory().size() << "\n"
+           << "loadSeconds=" << life.getLastLoad().seconds << "\n"
+           << "loadBytes=" << life.getLastLoad().bytes << "\n"
+           << "threads=" << life.getThreadCount() << "\n"
+           << "generations=" << generations << "\n"
+           << "seconds=" << std::setprecision(6) << seconds << "\n"
+           << "generationsPerSecond=" << genPerSecond << "\n"
+           << "cellsPerSecond=" << genPerSecond * cells << "\n"
+           << "population=" << life.getPopulation() << "\n"
+           << "finalState=" << outPath << "\n";
+    if (!checkpointPath.empty())
+        report << "checkpoint=" << checkpointPath << "\n"
+               << "checkpointsWritten=" << checkpoints.getWritten() << "\n"
+               << "checkpointsReplaced=" << checkpoints.getReplaced() << "\n"
+               << "checkpointSeconds=" << checkpoints.getLastSeconds() << "\n";
+    if (log.isOpen())
+        report << "log=" << logPath << "\n"
+               << "logFrames=" << log.getWritten() << "\n"
+               << "logBytes=" << log.getBytesWritten() << "\n";
+
+    return writeReport(report.str(), reportPath) ? 0 : 1;
+}
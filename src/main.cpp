@@ -2,10 +2,19 @@
 #include "Shader.h"
 #include "Camera.h"
 #include "Life.h"
+#include "Autotuner.h"
 #include "Cell.h"
 #include "InstanceBuffer.h"
+#include "GpuInstancer.h"
+#include "MeshRenderer.h"
+#include "VolumeRenderer.h"
 #include "Coloring.h"
 #include "Renderer.h"
+#include "Simulation.h"
+#include "AsyncLogWriter.h"
+#include "LogReplay.h"
+#include "Checkpoint.h"
+#include "Profiler.h"
 // GUI
 #include "gui/Panel.h"
 #include "gui/Button.h"
@@ -17,6 +26,11 @@
 #include <thread>
 #include <atomic>
 #include <string>
+#include <sstream>
+#include <iomanip>
+#include <cstdlib>
+#include <chrono>
+#include <mutex>
 
 std::vector<std::string> listStartingConfigs(const std::string& folder = "IO") {
     std::vector<std::string> configs;
@@ -34,9 +48,14 @@ std::vector<std::string> listStartingConfigs(const std::string& folder = "IO") {
     return configs;
 }
 
-int main() {
+int main(int argc, char** argv) {
     std::cout << "Starting 3D Game of Life..." << std::endl;
 
+    // "--resume <checkpoint>" restarts a run where its checkpoint left off
+    std::string resumePath;
+    for (int i = 1; i + 1 < argc; ++i)
+        if (std::string(argv[i]) == "--resume") resumePath = argv[++i];
+
     // Window
     sf::RenderWindow window(sf::VideoMode({1200, 800}), "3D Game of Life");
     window.setFramerateLimit(60);
@@ -57,6 +76,16 @@ int main() {
         std::cerr << "Failed to load shaders\n";
         return 1;
     }
+    Shader meshShader;
+    if (!meshShader.loadFromFile("shaders/mesh_vertex.glsl", "shaders/fragment.glsl")) {
+        std::cerr << "Failed to load shaders\n";
+        return 1;
+    }
+    Shader volumeShader;
+    if (!volumeShader.loadFromFile("shaders/volume_vertex.glsl", "shaders/volume_fragment.glsl")) {
+        std::cerr << "Failed to load shaders\n";
+        return 1;
+    }
 
     // Font
     sf::Font font;
@@ -70,13 +99,30 @@ int main() {
 
     // Game of Life core
     Life life(sizeX, sizeY, sizeZ);
+    if (!life.loadProfile(Life::machineProfilePath()))
+        std::cout << "No tuning profile for this machine, run 'autotune' to create one.\n";
     life.randomize();
 
     // Rendering modules
     Cell cell;
-    InstanceBuffer instanceBuffer(sizeX * sizeY * sizeZ);
+    InstanceBuffer instanceBuffer; // grows with the live cell count
     Coloring heatmap(5);
-    Renderer renderer(cell, instanceBuffer, heatmap);
+    Palette palette(heatmap);
+    Renderer renderer(cell, instanceBuffer, heatmap, palette);
+
+    // Compute-shader instance building, CPU fallback below GL 4.3
+    GpuInstancer gpuInstancer;
+    if (gpuInstancer.load("shaders"))
+        renderer.setGpuInstancer(&gpuInstancer);
+    else
+        std::cout << "GPU instancing unavailable, building instances on the CPU.\n";
+
+    // Surface mesh of the visible faces only, or a ray-marched volume whose
+    // cost follows the window size; 'render mesh|volume' switches to them
+    MeshRenderer meshRenderer(heatmap, palette);
+    VolumeRenderer volumeRenderer(heatmap, palette);
+    enum class RenderMode { Cubes, Mesh, Volume };
+    std::atomic<RenderMode> renderMode{RenderMode::Cubes};
 
     // GUI Panel
     float panelY = H * 3.f / 4.f;
@@ -85,6 +131,13 @@ int main() {
     float oneThird = W / 3.f;
     float oneSixth = W / 6.f;
 
+    Panel statsPanel(
+        sf::Vector2f(0.f, panelY),
+        sf::Vector2f(oneThird, panelHeight),
+        font,
+        ""
+    );
+
     Panel middlePanel(
         sf::Vector2f(oneThird, panelY),
         sf::Vector2f(oneThird, panelHeight),
@@ -108,9 +161,10 @@ int main() {
 
 // Timing
 sf::Clock clock;
-sf::Clock updateClock;
-float updateInterval = 0.5f; // base interval
-float simSpeed = 1.f;        // current simulation speed
+
+// Simulation thread; everything below touches life through it
+Simulation simulation(life);
+simulation.setUpdateInterval(0.5f);
 
 // Media control buttons
 float mediaButtonSize = 40.f;
@@ -118,7 +172,7 @@ float padding = 5.f;
 float startX = 5.f;
 float startY = 5.f;
 
-std::vector<std::string> symbols = {"Start", "Stop", ">", ">>"};
+std::vector<std::string> symbols = {"Start", "Stop", ">", ">>", "Max"};
 
 for (size_t i = 0; i < symbols.size(); ++i) {
     middlePanel.addButton(Button(
@@ -128,10 +182,12 @@ for (size_t i = 0; i < symbols.size(); ++i) {
         symbols[i],
         16,
         [&, i]() { 
-            if (i == 0) { simSpeed = 1.f; std::cout << "Simulation started (1x)\n"; }
-            else if (i == 1) { simSpeed = 0.f; std::cout << "Simulation stopped\n"; }
-            else if (i == 2) { simSpeed = 1.f; std::cout << "Simulation 2x speed\n"; }
-            else if (i == 3) { simSpeed = 3.f; std::cout << "Simulation 3x speed\n"; }
+            if (i != 4) simulation.setMaxThroughput(false);
+            if (i == 0) { simulation.setSpeed(1.f); std::cout << "Simulation started (1x)\n"; }
+            else if (i == 1) { simulation.setSpeed(0.f); std::cout << "Simulation stopped\n"; }
+            else if (i == 2) { simulation.setSpeed(1.f); std::cout << "Simulation 2x speed\n"; }
+            else if (i == 3) { simulation.setSpeed(3.f); std::cout << "Simulation 3x speed\n"; }
+            else if (i == 4) { simulation.setMaxThroughput(true); std::cout << "Simulation at max throughput\n"; }
         }
     ));
 }
@@ -142,57 +198,57 @@ for (size_t i = 0; i < symbols.size(); ++i) {
     middlePanel.addButton(Button(
         sf::Vector2f(20.f, 60.f), sf::Vector2f(120.f, 40.f),
         font, "Randomize", 18,
-        [&]() { life.randomize(); std::cout << "Randomized the grid.\n"; }
+        [&]() { simulation.post(Command::randomize()); std::cout << "Randomized the grid.\n"; }
     ));
 
     middlePanel.addButton(Button(
         sf::Vector2f(20.f, 110.f), sf::Vector2f(120.f, 40.f),
         font, "Clear", 18,
-        [&]() { life.clear(); std::cout << "Cleared the grid.\n"; }
+        [&]() { simulation.post(Command::clear()); std::cout << "Cleared the grid.\n"; }
     ));
 
     middlePanel.addButton(Button(
         sf::Vector2f(20.f, 160.f), sf::Vector2f(120.f, 40.f),
         font, "Update", 18,
-        [&]() { life.update(); std::cout << "Updated the grid.\n"; }
+        [&]() { simulation.post(Command::step()); std::cout << "Updated the grid.\n"; }
     ));
 
     // Toric toggle buttons
 middlePanel.addButton(Button(sf::Vector2f(20.f, 220.f), sf::Vector2f(120.f, 40.f), font, "Toric ON", 14,
-    [&]() { life.setToric(true); std::cout << "Toric mode ON\n"; }));
+    [&]() { simulation.post(Command::setToric(true)); std::cout << "Toric mode ON\n"; }));
 
 middlePanel.addButton(Button(sf::Vector2f(20.f, 270.f), sf::Vector2f(120.f, 40.f), font, "Toric OFF", 14,
-    [&]() { life.setToric(false); std::cout << "Toric mode OFF\n"; }));
+    [&]() { simulation.post(Command::setToric(false)); std::cout << "Toric mode OFF\n"; }));
 
     middlePanel.layoutButtons();
 
     // Right panel 1 buttons
     rightPanel1.addButton(Button(sf::Vector2f(20.f, 20.f), sf::Vector2f(83.f, 83.f), font, "Conway3D", 16,
-        [&]() { life.setMode(LifeMode::Current3D); std::cout << "Ruleset is conway's game of life 3D.\n"; }));
+        [&]() { simulation.post(Command::setMode(LifeMode::Current3D)); std::cout << "Ruleset is conway's game of life 3D.\n"; }));
 
     rightPanel1.addButton(Button(sf::Vector2f(20.f, 70.f), sf::Vector2f(83.f, 83.f), font, "Conway2D", 16,
-        [&]() { life.setMode(LifeMode::Conway2D); std::cout << "Ruleset is conway's game of life 2D.\n"; }));
+        [&]() { simulation.post(Command::setMode(LifeMode::Conway2D)); std::cout << "Ruleset is conway's game of life 2D.\n"; }));
 
     rightPanel1.addButton(Button(sf::Vector2f(20.f, 120.f), sf::Vector2f(83.f, 83.f), font, "Custom3D", 16,
-        [&]() { life.setMode(LifeMode::Custom3D); std::cout << "Ruleset is custom game of life 3D.\n"; }));
+        [&]() { simulation.post(Command::setMode(LifeMode::Custom3D)); std::cout << "Ruleset is custom game of life 3D.\n"; }));
 
     rightPanel1.addButton(Button(sf::Vector2f(20.f, 170.f), sf::Vector2f(83.f, 83.f), font, "Custom2D", 16,
-        [&]() { life.setMode(LifeMode::Custom2D); std::cout << "Ruleset is custom game of life 2D.\n"; }));
+        [&]() { simulation.post(Command::setMode(LifeMode::Custom2D)); std::cout << "Ruleset is custom game of life 2D.\n"; }));
 
     rightPanel1.layoutButtons();
 
     // Right panel 2 buttons
     rightPanel2.addButton(Button(sf::Vector2f(20.f, 20.f), sf::Vector2f(83.f, 83.f), font, "Heatmap", 16,
-        [&]() { heatmap.setPattern(ColoringPattern::Heatmap); std::cout << "Coloring scheme is heatmap.\n"; }));
+        [&]() { simulation.post(Command::run([&](Life&) { heatmap.setPattern(ColoringPattern::Heatmap); })); std::cout << "Coloring scheme is heatmap.\n"; }));
 
     rightPanel2.addButton(Button(sf::Vector2f(20.f, 70.f), sf::Vector2f(83.f, 83.f), font, "GrayScale", 16,
-        [&]() { heatmap.setPattern(ColoringPattern::Grayscale); std::cout << "Coloring scheme is grayscale.\n"; }));
+        [&]() { simulation.post(Command::run([&](Life&) { heatmap.setPattern(ColoringPattern::Grayscale); })); std::cout << "Coloring scheme is grayscale.\n"; }));
 
     rightPanel2.addButton(Button(sf::Vector2f(20.f, 120.f), sf::Vector2f(83.f, 83.f), font, "ZFade", 16,
-        [&]() { heatmap.setPattern(ColoringPattern::ZFade); std::cout << "Coloring scheme is z-fade.\n"; }));
+        [&]() { simulation.post(Command::run([&](Life&) { heatmap.setPattern(ColoringPattern::ZFade); })); std::cout << "Coloring scheme is z-fade.\n"; }));
 
     rightPanel2.addButton(Button(sf::Vector2f(20.f, 170.f), sf::Vector2f(83.f, 83.f), font, "BluePulse", 16,
-        [&]() { heatmap.setPattern(ColoringPattern::BluePulse); std::cout << "Coloring scheme is blue pulse.\n"; }));
+        [&]() { simulation.post(Command::run([&](Life&) { heatmap.setPattern(ColoringPattern::BluePulse); })); std::cout << "Coloring scheme is blue pulse.\n"; }));
 
     rightPanel2.layoutButtons();
 
@@ -204,22 +260,217 @@ middlePanel.addButton(Button(sf::Vector2f(20.f, 270.f), sf::Vector2f(120.f, 40.f
 
 // Terminal command handling
 std::atomic<bool> running{true};
-int logStep = 0;
+
+// Delta-encoded log of the loaded pattern, encoded and written on its own thread
+AsyncLogWriter logWriter(16, LogFullPolicy::Block);
+
+auto logGeneration = [&](const Life& l) {
+    auto snapshot = std::make_shared<LifeSnapshot>();
+    l.snapshot(*snapshot);
+    logWriter.submit(std::move(snapshot));
+};
+
+// While a log is open for replay, generations come from it instead of the rules
+LogReplay replay;
+
+// Checkpoints: the whole run plus coloring and camera, written atomically on
+// their own thread every checkpointEvery generations
+CheckpointWriter checkpoints;
+std::atomic<long long> checkpointEvery{1000};
+std::mutex viewMutex;
+ViewState currentView;  // render thread writes it every frame
+ViewState resumedView;  // handed back to the render thread by resume
+bool viewResumed = false;
+
+auto checkpointPath = [&]() { return "IO/" + currentPatternName + "/checkpoint.lifc"; };
+auto captureCheckpoint = [&](const Life& l) {
+    std::lock_guard<std::mutex> lock(viewMutex);
+    return Checkpoint::capture(l, currentPatternName, currentView);
+};
+
+// Reads on the calling thread, then swaps the run in between generations
+auto resumeFrom = [&](const std::string& path) {
+    auto checkpoint = std::make_shared<Checkpoint>();
+    if (!checkpoint->load(path)) return;
+    simulation.post(Command::run([&, checkpoint, path](Life& l) {
+        if (!checkpoint->restore(l)) return;
+        replay.close();
+        currentPatternName = checkpoint->name;
+        heatmap.setPattern(ColoringPattern(checkpoint->view.coloring));
+        {
+            std::lock_guard<std::mutex> lock(viewMutex);
+            resumedView = checkpoint->view;
+            viewResumed = true;
+        }
+        // A new log, so the one recorded before the checkpoint is kept
+        std::string log = "IO/" + currentPatternName + "/log-" + std::to_string(l.getGeneration()) + ".lifl";
+        bool logging = logWriter.open(log, l.getSizeX(), l.getSizeY(), l.getSizeZ());
+        if (logging) logGeneration(l);
+        std::cout << "Resumed '" << currentPatternName << "' at generation " << l.getGeneration()
+                  << " from " << path << (logging ? " (logging to " + log + ")\n" : " (could not open " + log + ", not logging)\n");
+    }));
+};
+
+// Log each generation while a real pattern is loaded
+simulation.setGenerationCallback([&](Life& l) {
+    long long every = checkpointEvery;
+    if (every > 0 && l.getGeneration() % every == 0 && !replay.isOpen())
+        checkpoints.submit(captureCheckpoint(l), checkpointPath());
+
+    if (!logWriter.isOpen()) return;
+    logGeneration(l);
+    if (l.getConsoleEcho()) l.print(std::cout, currentPatternName);
+});
+simulation.setStepFunction([&](Life& l) {
+    if (!replay.isOpen()) {
+        l.update();
+        return;
+    }
+    if (!replay.step(l)) {
+        simulation.setMaxThroughput(false);
+        simulation.setSpeed(0.f);
+        std::cout << "Replay reached generation " << replay.getGeneration() << ", paused.\n";
+    }
+});
+simulation.start();
+if (!resumePath.empty()) resumeFrom(resumePath);
+
 std::thread cmdThread([&]() {
+    PROFILE_THREAD("commands");
     std::string line;
     while (running) {
         if (!std::getline(std::cin, line)) break;
+        PROFILE_ZONE("command");
 
-        if (line == "clear") life.clear();
-        else if (line == "random") life.randomize();
-        else if (line == "update") life.update();
+        if (line == "clear") simulation.post(Command::clear());
+        else if (line == "random") simulation.post(Command::randomize());
+        else if (line == "update") simulation.post(Command::step());
         else if (line.rfind("init ", 0) == 0) { // "init <PatternName>"
             std::string pattern = line.substr(5);
-            currentPatternName = pattern;
-            logStep = 0;
-            std::cout << "Test loaded the file :" <<  life.loadFromFile("IO/" + pattern + "/initial.txt") << "\n";
-            life.loadFromFile(pattern);
-            std::cout << "Loaded pattern: " << pattern << " (logStep reset to 0)\n";
+            simulation.post(Command::run([&, pattern](Life& l) {
+                if (!l.loadFromFile(pattern)) return;
+                replay.close();
+                currentPatternName = pattern;
+                // Generation 0 becomes the log's first keyframe
+                std::string log = "IO/" + pattern + "/log.lifl";
+                if (logWriter.open(log, l.getSizeX(), l.getSizeY(), l.getSizeZ()))
+                    logGeneration(l);
+                else
+                    std::cout << "Could not open " << log << ", not logging.\n";
+            }));
+            std::cout << "Loading pattern: " << pattern << " (logging to IO/" << pattern << "/log.lifl)\n";
+        }
+        else if (line.rfind("save ", 0) == 0) { // "save <file.lifb|file.rle>"
+            std::string path = line.substr(5);
+            bool rle = std::filesystem::path(path).extension() == ".rle";
+            simulation.post(Command::run([&, path, rle](Life& l) {
+                bool saved = rle ? l.saveRLE(path, currentPatternName) : l.saveBinary(path);
+                if (saved) std::cout << "Saved generation " << l.getGeneration() << " to " << path << "\n";
+            }));
+        }
+        else if (line.rfind("load ", 0) == 0) { // "load <file.lifb|file.rle>"
+            std::string path = line.substr(5);
+            bool rle = std::filesystem::path(path).extension() == ".rle";
+            simulation.post(Command::run([&, path, rle](Life& l) {
+                if (!(rle ? l.loadRLE(path) : l.loadBinary(path))) return;
+                std::cout << "Loaded " << path << " (" << l.getSizeX() << "x" << l.getSizeY() << "x" << l.getSizeZ()
+                          << ", generation " << l.getGeneration() << ")\n";
+                if (!logWriter.isOpen()) return;
+
+                // The grid may have a new size: continue in a new log, as resume does
+                std::string log = "IO/" + currentPatternName + "/log-" + std::to_string(l.getGeneration()) + ".lifl";
+                logWriter.close();
+                if (logWriter.open(log, l.getSizeX(), l.getSizeY(), l.getSizeZ())) {
+                    logGeneration(l);
+                    std::cout << "Logging to " << log << "\n";
+                } else {
+                    std::cout << "Could not open " << log << ", not logging.\n";
+                }
+            }));
+        }
+        else if (line == "replay off") {
+            simulation.post(Command::run([&](Life&) { replay.close(); }));
+            std::cout << "Replay off, the rules drive the grid again.\n";
+        }
+        else if (line.rfind("replay ", 0) == 0) { // "replay <file.lifl>"
+            std::string path = line.substr(7);
+            // Finish and close the current log first: it may be the one replayed,
+            // and replayed generations must not be logged again
+            logWriter.close();
+            logWriter.flush();
+            simulation.setMaxThroughput(false);
+            simulation.setSpeed(0.f);
+            simulation.post(Command::run([&, path](Life& l) {
+                if (!replay.open(path) || !replay.seekFrame(0, l)) {
+                    replay.close();
+                    return;
+                }
+                std::cout << "Replaying " << path << ": " << replay.getFrameCount() << " frames, generations "
+                          << replay.getFirstGeneration() << " to " << replay.getLastGeneration()
+                          << (replay.getReader().usedIndex() ? "" : " (no index, frames scanned)")
+                          << ". Use seek, forward, backward, start or max.\n";
+            }));
+        }
+        else if (line.rfind("seek ", 0) == 0) { // "seek <generation>"
+            long long generation = std::atoll(line.substr(5).c_str());
+            simulation.post(Command::run([&, generation](Life& l) {
+                if (!replay.isOpen()) {
+                    std::cout << "Nothing to seek in, open a log with 'replay <file>' first.\n";
+                    return;
+                }
+                auto started = std::chrono::steady_clock::now();
+                if (replay.seek(generation, l)) {
+                    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+                    std::cout << "At generation " << replay.getGeneration() << " (" << ms << " ms)\n";
+                }
+            }));
+        }
+        else if (line == "forward" || line == "backward") {
+            bool forward = line == "forward";
+            simulation.post(Command::run([&, forward](Life&) { replay.setForward(forward); }));
+            std::cout << "Replay plays " << line << ".\n";
+        }
+        else if (line.rfind("checkpoint every ", 0) == 0) { // "checkpoint every <n>"
+            long long every = std::atoll(line.substr(17).c_str());
+            checkpointEvery = std::max(0LL, every);
+            if (every > 0) std::cout << "Checkpoint every " << every << " generations.\n";
+            else std::cout << "Periodic checkpoints off.\n";
+        }
+        else if (line == "checkpoint" || line.rfind("checkpoint ", 0) == 0) { // "checkpoint [file.lifc]"
+            std::string path = line.size() > 11 ? line.substr(11) : "";
+            simulation.post(Command::run([&, path](Life& l) {
+                std::string target = path.empty() ? checkpointPath() : path;
+                checkpoints.submit(captureCheckpoint(l), target);
+                std::cout << "Checkpoint of generation " << l.getGeneration() << " queued for " << target << "\n";
+            }));
+        }
+        else if (line.rfind("resume ", 0) == 0) { // "resume <file.lifc>"
+            resumeFrom(line.substr(7));
+        }
+        else if (line == "echo on" || line == "echo off") {
+            bool echo = line == "echo on";
+            simulation.post(Command::run([echo](Life& l) { l.setConsoleEcho(echo); }));
+            std::cout << "Console echo of logged generations " << (echo ? "on" : "off") << ".\n";
+        }
+        else if (line.rfind("logpolicy ", 0) == 0) { // "logpolicy block|drop|coalesce"
+            LogFullPolicy policy;
+            if (AsyncLogWriter::parsePolicy(line.substr(10), policy)) {
+                logWriter.setPolicy(policy);
+                std::cout << "Full log queue policy: " << AsyncLogWriter::policyName(policy) << ".\n";
+            } else {
+                std::cout << "Unknown policy: " << line.substr(10) << "\n";
+            }
+        }
+        else if (line.rfind("logqueue ", 0) == 0) { // "logqueue <depth>"
+            int depth = std::atoi(line.substr(9).c_str());
+            logWriter.setQueueDepth(depth > 0 ? size_t(depth) : 1);
+            std::cout << "Log queue depth set to " << (depth > 0 ? depth : 1) << ".\n";
+        }
+        else if (line == "logstats") {
+            std::cout << "Log: " << logWriter.getQueued() << " queued, " << logWriter.getWritten() << " written, "
+                      << logWriter.getDropped() << " dropped, " << logWriter.getCoalesced() << " coalesced, "
+                      << logWriter.getPending() << " pending, " << logWriter.getBytesWritten() << " bytes ("
+                      << AsyncLogWriter::policyName(logWriter.getPolicy()) << ")\n";
         }
         else if (line == "list") {
             auto configs = listStartingConfigs("IO");
@@ -229,53 +480,125 @@ std::thread cmdThread([&]() {
         }
         // Simulation controls
         else if (line == "stop") {
-            simSpeed = 0.f;
+            simulation.setMaxThroughput(false);
+            simulation.setSpeed(0.f);
             std::cout << "Simulation stopped\n";
         }
         else if (line == "start") {
-            simSpeed = 1.f;
+            simulation.setMaxThroughput(false);
+            simulation.setSpeed(1.f);
             std::cout << "Simulation started (1x)\n";
         }
         else if (line == "speed1") {
-            simSpeed = 1.f;
+            simulation.setMaxThroughput(false);
+            simulation.setSpeed(1.f);
             std::cout << "Simulation speed 2x\n";
         }
         else if (line == "speed2") {
-            simSpeed = 3.f;
+            simulation.setMaxThroughput(false);
+            simulation.setSpeed(3.f);
             std::cout << "Simulation speed 3x\n";
         }
+        else if (line == "max") {
+            simulation.setMaxThroughput(true);
+            std::cout << "Simulation at max throughput\n";
+        }
+        else if (line == "rate") {
+            std::cout << simulation.getGenerationsPerSecond() << " generations/s\n";
+        }
         // Ruleset commands
         else if (line == "Conway3D") {
-            life.setMode(LifeMode::Current3D);
+            simulation.post(Command::setMode(LifeMode::Current3D));
             std::cout << "Ruleset set to Conway 3D.\n";
         }
         else if (line == "Conway2D") {
-            life.setMode(LifeMode::Conway2D);
+            simulation.post(Command::setMode(LifeMode::Conway2D));
             std::cout << "Ruleset set to Conway 2D.\n";
         }
         else if (line == "Custom3D") {
-            life.setMode(LifeMode::Custom3D);
+            simulation.post(Command::setMode(LifeMode::Custom3D));
             std::cout << "Ruleset set to Custom 3D.\n";
         }
         else if (line == "Custom2D") {
-            life.setMode(LifeMode::Custom2D);
+            simulation.post(Command::setMode(LifeMode::Custom2D));
             std::cout << "Ruleset set to Custom 2D.\n";
         }
+        // Engine commands
+        else if (line == "engine") {
+            simulation.post(Command::run([](Life& l) {
+                std::cout << "Engine: " << Life::engineName(l.getEngine())
+                          << " (running " << Life::engineName(l.getActiveEngine()) << ")\n";
+                for (const auto& s : l.getEngineHistory())
+                    std::cout << " - gen " << s.generation << ": " << Life::engineName(s.from)
+                              << " -> " << Life::engineName(s.to)
+                              << " (density " << s.density << ", activity " << s.activity << ")\n";
+            }));
+        }
+        else if (line.rfind("engine ", 0) == 0) {
+            LifeEngine engine;
+            if (Life::parseEngine(line.substr(7), engine)) {
+                simulation.post(Command::setEngine(engine));
+                std::cout << "Engine set to " << Life::engineName(engine) << ".\n";
+            } else {
+                std::cout << "Unknown engine: " << line.substr(7) << "\n";
+            }
+        }
+        else if (line == "autotune" || line.rfind("autotune ", 0) == 0) { // "autotune [XxYxZ]"
+            int tx = 128, ty = 128, tz = 128;
+            if (line.size() > 9 && !Life::parseDims(line.substr(9), tx, ty, tz)) {
+                std::cout << "Usage: autotune <X>x<Y>x<Z>\n";
+                continue;
+            }
+            Autotuner tuner(tx, ty, tz);
+            tuner.run();
+            if (tuner.saveProfile(Life::machineProfilePath()))
+                simulation.post(Command::run([](Life& l) { l.loadProfile(Life::machineProfilePath()); }));
+        }
+        // Profiler commands
+        else if (line.rfind("profile ", 0) == 0) { // "profile <file.json>" or "profile clear"
+            if (!Profiler::enabled())
+                std::cout << "Profiling is compiled out, rebuild with 'make PROFILE=1'.\n";
+            else if (line == "profile clear") {
+                Profiler::clear();
+                std::cout << "Profile cleared.\n";
+            }
+            else
+                Profiler::writeChromeTrace(line.substr(8));
+        }
+        else if (line == "instances gpu" || line == "instances cpu") {
+            renderer.setGpuInstancing(line == "instances gpu");
+            if (line == "instances gpu" && !gpuInstancer.isReady())
+                std::cout << "GPU instancing is unavailable on this context, staying on the CPU.\n";
+            else
+                std::cout << "Instances are built on the " << (line == "instances gpu" ? "GPU" : "CPU") << ".\n";
+        }
+        else if (line == "render cubes") {
+            renderMode = RenderMode::Cubes;
+            std::cout << "Drawing every live cell as an instanced cube.\n";
+        }
+        else if (line == "render mesh") {
+            renderMode = RenderMode::Mesh;
+            std::cout << "Drawing visible faces as chunked meshes.\n";
+        }
+        else if (line == "render volume") {
+            renderMode = RenderMode::Volume;
+            std::cout << "Ray marching the grid as a volume.\n";
+        }
         // Coloring mode commands
         else if (line == "Heatmap") {
-            heatmap.setPattern(ColoringPattern::Heatmap);
+            simulation.post(Command::run([&](Life&) { heatmap.setPattern(ColoringPattern::Heatmap); }));
             std::cout << "Coloring set to Heatmap.\n";
         }
         else if (line == "GrayScale") {
-            heatmap.setPattern(ColoringPattern::Grayscale);
+            simulation.post(Command::run([&](Life&) { heatmap.setPattern(ColoringPattern::Grayscale); }));
             std::cout << "Coloring set to Grayscale.\n";
         }
         else if (line == "ZFade") {
-            heatmap.setPattern(ColoringPattern::ZFade);
+            simulation.post(Command::run([&](Life&) { heatmap.setPattern(ColoringPattern::ZFade); }));
             std::cout << "Coloring set to ZFade.\n";
         }
         else if (line == "BluePulse") {
-            heatmap.setPattern(ColoringPattern::BluePulse);
+            simulation.post(Command::run([&](Life&) { heatmap.setPattern(ColoringPattern::BluePulse); }));
             std::cout << "Coloring set to BluePulse.\n";
         }
         else if (line == "help") {
@@ -286,14 +609,37 @@ std::thread cmdThread([&]() {
                 "  update        - Perform one simulation step.\n"
                 "  init <name>   - Load initial pattern from folder 'IO/<name>'.\n"
                 "  list          - List all available initial patterns.\n"
+                "  save <file>   - Save the grid as a binary snapshot, or as RLE if <file> ends in .rle.\n"
+                "  load <file>   - Load a binary snapshot or an RLE pattern (.rle).\n"
+                "  replay <file> - Play a generation log (.lifl) instead of simulating.\n"
+                "  replay off    - Return to simulating from the replayed generation.\n"
+                "  seek <gen>    - Jump to a generation of the replayed log.\n"
+                "  forward       - Replay forward (start/max/update play it).\n"
+                "  backward      - Replay backward.\n"
+                "  checkpoint [file] - Save the whole run (default IO/<name>/checkpoint.lifc).\n"
+                "  checkpoint every <n> - Checkpoint every n generations (0 turns it off).\n"
+                "  resume <file> - Continue a run from a checkpoint (also: --resume <file>).\n"
+                "  echo on|off   - Print each logged generation to the console.\n"
+                "  logpolicy <p> - When the log queue is full: block, drop or coalesce.\n"
+                "  logqueue <n>  - Snapshots the log queue holds before the policy applies.\n"
+                "  logstats      - Show queued, written and dropped log snapshot counts.\n"
                 "  stop          - Pause the simulation.\n"
                 "  start         - Start/resume simulation at 1x speed.\n"
                 "  speed1        - Set simulation speed to 2x.\n"
                 "  speed2        - Set simulation speed to 3x.\n"
+                "  max           - Run generations back-to-back as fast as possible.\n"
+                "  rate          - Print the measured generations per second.\n"
                 "  Conway3D      - Set ruleset to Conway 3D.\n"
                 "  Conway2D      - Set ruleset to Conway 2D.\n"
                 "  Custom3D      - Set ruleset to Custom 3D.\n"
                 "  Custom2D      - Set ruleset to Custom 2D.\n"
+                "  engine        - Show the current engine and its switch history.\n"
+                "  engine <name> - Use engine dense, bitsliced, sparse or auto.\n"
+                "  autotune [XxYxZ] - Tune kernel, threads and slab size for this machine.\n"
+                "  profile <file> - Write recorded zones as a Chrome trace (PROFILE=1 builds).\n"
+                "  profile clear - Drop the zones recorded so far.\n"
+                "  instances gpu|cpu - Build render instances with compute shaders or on the CPU.\n"
+                "  render cubes|mesh|volume - Draw instanced cubes, visible faces only, or a ray-marched volume.\n"
                 "  Heatmap       - Set coloring mode to Heatmap.\n"
                 "  GrayScale     - Set coloring mode to Grayscale.\n"
                 "  ZFade         - Set coloring mode to ZFade.\n"
@@ -308,11 +654,18 @@ std::thread cmdThread([&]() {
 
 
 
+    // Live generations/second readout, also echoed to the terminal in max mode
+    sf::Clock statsClock;
+
+    PROFILE_THREAD("render");
+
     // Event loop
     while (window.isOpen()) {
+        PROFILE_ZONE("frame");
         float deltaTime = clock.restart().asSeconds();
 
         while (auto evOpt = window.pollEvent()) {
+            PROFILE_ZONE("event");
             const sf::Event& event = *evOpt;
 
             if (event.is<sf::Event::Closed>()) {
@@ -324,9 +677,9 @@ std::thread cmdThread([&]() {
                 if (kp->code == sf::Keyboard::Key::Escape)
                     window.close();
                 else if (kp->code == sf::Keyboard::Key::C)
-                    life.clear();
+                    simulation.post(Command::clear());
                 else if (kp->code == sf::Keyboard::Key::Space)
-                    life.update();
+                    simulation.post(Command::step());
             }
 
             if (auto mp = event.getIf<sf::Event::MouseButtonPressed>()) {
@@ -342,21 +695,23 @@ std::thread cmdThread([&]() {
             camera.handleEvent(event);
         }
 
-        camera.update(deltaTime);
-
-        // --- update & log ---
-        if (updateClock.getElapsedTime().asSeconds() >= updateInterval / (simSpeed > 0 ? simSpeed : 1.f)) {
-            if (simSpeed > 0.f) { // only update if not paused
-                life.update();
-
-                // Only save if a real pattern is loaded
-                if (currentPatternName != "none") {
-                    life.saveToFile(currentPatternName, logStep++);
-                }
+        {
+            // Hand the view to checkpoints, or take it back from a resume
+            std::lock_guard<std::mutex> lock(viewMutex);
+            if (viewResumed) {
+                camera.setOrbit(resumedView.cameraYaw, resumedView.cameraPitch, resumedView.cameraDistance);
+                camera.setTarget(glm::vec3(resumedView.cameraTarget[0], resumedView.cameraTarget[1], resumedView.cameraTarget[2]));
+                viewResumed = false;
             }
-            updateClock.restart();
+            currentView.coloring = int(heatmap.getPattern());
+            currentView.cameraYaw = camera.getYaw();
+            currentView.cameraPitch = camera.getPitch();
+            currentView.cameraDistance = camera.getDistance();
+            for (int i = 0; i < 3; ++i) currentView.cameraTarget[i] = camera.getTarget()[i];
         }
 
+        camera.update(deltaTime);
+
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -364,18 +719,49 @@ std::thread cmdThread([&]() {
         glm::mat4 view = camera.getViewMatrix();
         glm::mat4 projection = camera.getProjectionMatrix(aspect);
 
-        renderer.render(life, shader, view, projection);
+        const LifeSnapshot& snapshot = simulation.latest();
+        renderer.setViewportHeight(int(window.getSize().y));
+        switch (renderMode.load()) {
+            case RenderMode::Cubes:
+                renderer.render(snapshot, shader, view, projection);
+                break;
+            case RenderMode::Mesh:
+                meshRenderer.render(snapshot, meshShader, view, projection);
+                break;
+            case RenderMode::Volume:
+                volumeRenderer.render(snapshot, volumeShader, view, projection);
+                break;
+        }
 
-        window.pushGLStates();
-        middlePanel.render(window);
-        rightPanel1.render(window);
-        rightPanel2.render(window);
-        window.popGLStates();
+        std::ostringstream stats;
+        stats << "Gen " << snapshot.getGeneration() << "  |  "
+              << std::fixed << std::setprecision(1) << simulation.getGenerationsPerSecond() << " gen/s"
+              << (simulation.isMaxThroughput() ? " (max)" : "");
+        statsPanel.setTitle(stats.str());
+
+        if (simulation.isMaxThroughput() && statsClock.getElapsedTime().asSeconds() >= 2.f) {
+            std::cout << stats.str() << "\n";
+            statsClock.restart();
+        }
+
+        {
+            PROFILE_ZONE("Panel::render");
+            window.pushGLStates();
+            statsPanel.render(window);
+            middlePanel.render(window);
+            rightPanel1.render(window);
+            rightPanel2.render(window);
+            window.popGLStates();
+        }
 
+        PROFILE_ZONE("display");
         window.display();
     }
 
     running = false;
+    simulation.stop();
+    logWriter.flush();
+    checkpoints.flush();
     if (cmdThread.joinable()) cmdThread.join();
 
     std::cout << "Exiting application..." << std::endl;
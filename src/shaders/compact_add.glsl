@@ -0,0 +1,18 @@
+#version 430 core
+
+// Stage 3: add the scanned block totals back so offsets become global
+
+layout(local_size_x = 256) in;
+
+layout(std430, binding = 1) buffer Data { uint data[]; };
+layout(std430, binding = 2) readonly buffer Sums { uint sums[]; };
+
+uniform int count;
+
+void main()
+{
+    uint group = gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x;
+    uint i = group * 256u + gl_LocalInvocationID.x;
+    if (i < uint(count))
+        data[i] += sums[group];
+}
@@ -0,0 +1,58 @@
+#version 430 core
+
+// Stage 5: one DrawElementsIndirectCommand per chunk. A chunk's instances
+// start at the scanned offset of its first slot and end where the next
+// chunk's start, or after the last slot's cells for the final chunk.
+
+layout(local_size_x = 256) in;
+
+layout(std430, binding = 0) readonly buffer Grid { uint grid[]; };
+layout(std430, binding = 1) readonly buffer Offsets { uint offsets[]; };
+layout(std430, binding = 4) writeonly buffer Commands { uint commands[]; };
+
+uniform int count;        // scanned slots, a whole number of chunks
+uniform int chunksX;
+uniform int chunksY;
+uniform int sizeY;
+uniform int sizeZ;
+uniform int wordsPerRow;  // 64-bit words, as in LifeSnapshot
+
+// Slots run chunk by chunk (64x64x64 cells, x fastest between chunks), and
+// inside a chunk row by row, two 32-bit halves per 64-cell word. Rows past
+// the grid's edge are empty. Returns the grid word, or -1 for padding.
+int gridWord(uint slot, out int y, out int z)
+{
+    uint chunk = slot / 8192u;
+    uint inChunk = slot % 8192u;
+    int cx = int(chunk % uint(chunksX));
+    int cy = int(chunk / uint(chunksX)) % chunksY;
+    int cz = int(chunk / uint(chunksX)) / chunksY;
+    y = cy * 64 + int((inChunk >> 1) & 63u);
+    z = cz * 64 + int(inChunk >> 7);
+    if (y >= sizeY || z >= sizeZ) return -1;
+    return ((z * sizeY + y) * wordsPerRow + cx) * 2 + int(inChunk & 1u);
+}
+
+void main()
+{
+    uint group = gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x;
+    uint chunk = group * gl_WorkGroupSize.x + gl_LocalInvocationID.x;
+    uint chunks = uint(count) / 8192u;
+    if (chunk >= chunks) return;
+
+    uint first = offsets[chunk * 8192u];
+    uint end;
+    if (chunk + 1u < chunks) {
+        end = offsets[(chunk + 1u) * 8192u];
+    } else {
+        int y, z;
+        int word = gridWord(uint(count) - 1u, y, z);
+        end = offsets[count - 1] + (word < 0 ? 0u : uint(bitCount(grid[word])));
+    }
+
+    commands[chunk * 5u + 0u] = 36u;          // count
+    commands[chunk * 5u + 1u] = end - first;  // instanceCount
+    commands[chunk * 5u + 2u] = 0u;           // firstIndex
+    commands[chunk * 5u + 3u] = 0u;           // baseVertex
+    commands[chunk * 5u + 4u] = first;        // baseInstance
+}
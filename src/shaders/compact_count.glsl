@@ -0,0 +1,43 @@
+#version 430 core
+
+// Stage 1 of the GPU instance build: live cells per 32-bit grid word
+
+layout(local_size_x = 256) in;
+
+layout(std430, binding = 0) readonly buffer Grid { uint grid[]; };
+layout(std430, binding = 1) writeonly buffer Offsets { uint offsets[]; };
+
+uniform int count;        // scanned slots, a whole number of chunks
+uniform int chunksX;
+uniform int chunksY;
+uniform int sizeY;
+uniform int sizeZ;
+uniform int wordsPerRow;  // 64-bit words, as in LifeSnapshot
+
+// Slots run chunk by chunk (64x64x64 cells, x fastest between chunks), and
+// inside a chunk row by row, two 32-bit halves per 64-cell word. Rows past
+// the grid's edge are empty. Returns the grid word, or -1 for padding.
+int gridWord(uint slot, out int y, out int z)
+{
+    uint chunk = slot / 8192u;
+    uint inChunk = slot % 8192u;
+    int cx = int(chunk % uint(chunksX));
+    int cy = int(chunk / uint(chunksX)) % chunksY;
+    int cz = int(chunk / uint(chunksX)) / chunksY;
+    y = cy * 64 + int((inChunk >> 1) & 63u);
+    z = cz * 64 + int(inChunk >> 7);
+    if (y >= sizeY || z >= sizeZ) return -1;
+    return ((z * sizeY + y) * wordsPerRow + cx) * 2 + int(inChunk & 1u);
+}
+
+void main()
+{
+    // Large grids are dispatched as a 2D array of work groups
+    uint group = gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x;
+    uint i = group * gl_WorkGroupSize.x + gl_LocalInvocationID.x;
+    if (i >= uint(count)) return;
+
+    int y, z;
+    int word = gridWord(i, y, z);
+    offsets[i] = word < 0 ? 0u : uint(bitCount(grid[word]));
+}
@@ -0,0 +1,103 @@
+#version 430 core
+
+// Stage 4: every grid word writes its live cells at its scanned offset as
+// PackedInstance (cell bit fields, palette shade). Shades follow Coloring.cpp.
+
+layout(local_size_x = 256) in;
+
+layout(std430, binding = 0) readonly buffer Grid { uint grid[]; };
+layout(std430, binding = 1) readonly buffer Offsets { uint offsets[]; };
+layout(std430, binding = 3) writeonly buffer Instances { uvec2 instances[]; };
+
+uniform int count;        // scanned slots, a whole number of chunks
+uniform int chunksX;
+uniform int chunksY;
+uniform int sizeY;
+uniform int sizeZ;
+uniform int wordsPerRow;  // 64-bit words, as in LifeSnapshot
+uniform int sizeX;
+uniform int toric;
+uniform int radius;
+uniform int byDepth;      // Coloring::shadesByDepth
+uniform float maxDensity; // Coloring::kMaxDensity
+uniform int bitsX;
+uniform int bitsY;
+
+// Slots run chunk by chunk (64x64x64 cells, x fastest between chunks), and
+// inside a chunk row by row, two 32-bit halves per 64-cell word. Rows past
+// the grid's edge are empty. Returns the grid word, or -1 for padding.
+int gridWord(uint slot, out int y, out int z)
+{
+    uint chunk = slot / 8192u;
+    uint inChunk = slot % 8192u;
+    int cx = int(chunk % uint(chunksX));
+    int cy = int(chunk / uint(chunksX)) % chunksY;
+    int cz = int(chunk / uint(chunksX)) / chunksY;
+    y = cy * 64 + int((inChunk >> 1) & 63u);
+    z = cz * 64 + int(inChunk >> 7);
+    if (y >= sizeY || z >= sizeZ) return -1;
+    return ((z * sizeY + y) * wordsPerRow + cx) * 2 + int(inChunk & 1u);
+}
+
+bool getCell(int x, int y, int z)
+{
+    if (toric != 0) {
+        x = (x + sizeX) % sizeX;
+        y = (y + sizeY) % sizeY;
+        z = (z + sizeZ) % sizeZ;
+    } else if (x < 0 || x >= sizeX || y < 0 || y >= sizeY || z < 0 || z >= sizeZ) {
+        return false;
+    }
+    uint word = uint((z * sizeY + y) * wordsPerRow + (x >> 6)) * 2u + uint((x >> 5) & 1);
+    return ((grid[word] >> uint(x & 31)) & 1u) != 0u;
+}
+
+float computeDensity(int x, int y, int z)
+{
+    int live = 0;
+    int maxNeighbors = 0;
+    for (int dz = -radius; dz <= radius; ++dz)
+        for (int dy = -radius; dy <= radius; ++dy)
+            for (int dx = -radius; dx <= radius; ++dx) {
+                int nx = x + dx, ny = y + dy, nz = z + dz;
+                if (toric != 0 || (nx >= 0 && nx < sizeX && ny >= 0 && ny < sizeY && nz >= 0 && nz < sizeZ)) {
+                    maxNeighbors++;
+                    if (getCell(nx, ny, nz)) live++;
+                }
+            }
+    return maxNeighbors > 0 ? float(live) / float(maxNeighbors) : 0.0;
+}
+
+// Coloring::getShade
+uint cellShade(int x, int y, int z)
+{
+    if (byDepth != 0)
+        return sizeZ > 1 ? uint(float(z) / float(sizeZ - 1) * 255.0 + 0.5) : 0u;
+    return uint(clamp(computeDensity(x, y, z) / maxDensity, 0.0, 1.0) * 255.0 + 0.5);
+}
+
+void main()
+{
+    uint group = gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x;
+    uint i = group * gl_WorkGroupSize.x + gl_LocalInvocationID.x;
+    if (i >= uint(count)) return;
+
+    int y, z;
+    int word = gridWord(i, y, z);
+    if (word < 0) return;
+
+    uint bits = grid[word];
+    uint next = offsets[i];
+
+    // 32-bit word i is the low (even) or high (odd) half of a 64-bit word
+    int baseX = (word >> 1) % wordsPerRow * 64 + (word & 1) * 32;
+
+    while (bits != 0u) {
+        int bit = findLSB(bits);
+        bits &= bits - 1u;
+        int x = baseX + bit;
+
+        uint cell = uint(x) | (uint(y) << uint(bitsX)) | (uint(z) << uint(bitsX + bitsY));
+        instances[next++] = uvec2(cell, cellShade(x, y, z));
+    }
+}
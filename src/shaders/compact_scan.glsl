@@ -0,0 +1,37 @@
+#version 430 core
+
+// Stage 2: exclusive prefix sum of each 256-value block in place, with the
+// block totals written out for the next level to scan
+
+layout(local_size_x = 256) in;
+
+layout(std430, binding = 1) buffer Data { uint data[]; };
+layout(std430, binding = 2) writeonly buffer Sums { uint sums[]; };
+
+uniform int count;
+
+shared uint partial[256];
+
+void main()
+{
+    uint group = gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x;
+    uint local = gl_LocalInvocationID.x;
+    uint i = group * 256u + local;
+
+    uint value = i < uint(count) ? data[i] : 0u;
+    partial[local] = value;
+    barrier();
+
+    // Inclusive Hillis-Steele scan in shared memory
+    for (uint offset = 1u; offset < 256u; offset <<= 1) {
+        uint add = local >= offset ? partial[local - offset] : 0u;
+        barrier();
+        partial[local] += add;
+        barrier();
+    }
+
+    if (i < uint(count))
+        data[i] = partial[local] - value;
+    if (local == 255u)
+        sums[group] = partial[255];
+}
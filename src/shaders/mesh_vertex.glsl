@@ -0,0 +1,17 @@
+#version 460 core
+
+// Surface mesh from MeshRenderer: one vertex per visible face corner
+layout(location = 0) in vec3 aPos;    // already centered on the grid
+layout(location = 1) in uint aShade;  // palette index
+
+out vec3 vColor;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform sampler1D palette;
+
+void main()
+{
+    gl_Position = projection * view * vec4(aPos, 1.0);
+    vColor = texelFetch(palette, int(aShade), 0).rgb;
+}
@@ -4,22 +4,33 @@
 layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec3 aColor;  // not used but must stay
 
-// Per-instance attributes
-layout(location = 2) in vec3 instanceOffset;
-layout(location = 3) in vec3 instanceColor;
+// Per-instance attributes (PackedInstance)
+layout(location = 2) in uint instanceCell;   // x | y << bitsX | z << (bitsX + bitsY)
+layout(location = 3) in uint instanceShade;  // palette index
 
 out vec3 vColor;
 
 uniform mat4 view;
 uniform mat4 projection;
+uniform int bitsX;
+uniform int bitsY;
+uniform vec3 gridOrigin;  // -size / 2, centers the grid on the origin
+uniform int cellScale;    // 1 for cells; 2 or 4 when the instance is a coarse block
+uniform sampler1D palette;  // Coloring::buildPalette for the current pattern
 
 void main()
 {
+    // Unpack the cell coordinates
+    uint x = bitfieldExtract(instanceCell, 0, bitsX);
+    uint y = bitfieldExtract(instanceCell, bitsX, bitsY);
+    uint z = bitfieldExtract(instanceCell, bitsX + bitsY, 32 - bitsX - bitsY);
+    vec3 instanceOffset = (vec3(x, y, z) + 0.5) * float(cellScale) - 0.5 + gridOrigin;
+
     // Move cube according to instance offset
-    vec3 worldPos = aPos + instanceOffset;
+    vec3 worldPos = aPos * float(cellScale) + instanceOffset;
 
     gl_Position = projection * view * vec4(worldPos, 1.0);
 
     // Send per-instance color to fragment shader
-    vColor = instanceColor;
+    vColor = texelFetch(palette, int(instanceShade), 0).rgb;
 }
@@ -0,0 +1,143 @@
+#version 460 core
+
+// Ray marches the packed grid from VolumeRenderer. The occupancy pyramid
+// lets a ray cross empty space a whole texel at a time: it descends a level
+// when the texel it is in has live cells, tests single cells only inside
+// occupied bricks, and climbs back up when it leaves its parent texel.
+
+in vec2 vNdc;
+out vec4 fragColor;
+
+uniform mat4 viewProjection;
+uniform mat4 inverseViewProjection;
+uniform vec3 gridOrigin;  // world position of grid coordinate 0
+uniform int sizeX;
+uniform int sizeY;
+uniform int sizeZ;
+uniform int toric;
+uniform int radius;
+uniform int byDepth;       // Coloring::shadesByDepth
+uniform float maxDensity;  // Coloring::kMaxDensity
+uniform int brick;         // cells per level 0 texel along each axis
+uniform int topLevel;      // the single-texel level of the pyramid
+uniform int maxSteps;
+uniform sampler1D palette;
+uniform usampler3D cells;      // 32 cells per texel, bit x & 31 of texel x >> 5
+uniform usampler3D occupancy;  // nonzero where a texel has live cells
+
+const float kEpsilon = 1e-3;
+
+bool getCell(ivec3 c)
+{
+    return ((texelFetch(cells, ivec3(c.x >> 5, c.y, c.z), 0).r >> uint(c.x & 31)) & 1u) != 0u;
+}
+
+// Live cells in x = lo..hi of one row, all inside the grid
+int countRow(int y, int z, int lo, int hi)
+{
+    int live = 0;
+    for (int w = lo >> 5; w <= hi >> 5; ++w) {
+        int first = max(lo - w * 32, 0);
+        int last = min(hi - w * 32, 31);
+        uint mask = last - first == 31 ? 0xFFFFFFFFu : ((1u << uint(last - first + 1)) - 1u) << uint(first);
+        live += bitCount(texelFetch(cells, ivec3(w, y, z), 0).r & mask);
+    }
+    return live;
+}
+
+// LifeSnapshot::computeDensity, counted a row segment at a time
+float computeDensity(ivec3 c)
+{
+    int live = 0;
+    int maxNeighbors = 0;
+    for (int dz = -radius; dz <= radius; ++dz)
+        for (int dy = -radius; dy <= radius; ++dy) {
+            int y = c.y + dy, z = c.z + dz;
+            int lo = c.x - radius, hi = c.x + radius;
+            if (toric != 0) {
+                y = (y % sizeY + sizeY) % sizeY;
+                z = (z % sizeZ + sizeZ) % sizeZ;
+                // Wrapped pieces of the row, as often as the radius needs
+                while (lo <= hi) {
+                    int from = (lo % sizeX + sizeX) % sizeX;
+                    int count = min(hi - lo + 1, sizeX - from);
+                    live += countRow(y, z, from, from + count - 1);
+                    lo += count;
+                }
+                maxNeighbors += 2 * radius + 1;
+            } else if (y >= 0 && y < sizeY && z >= 0 && z < sizeZ) {
+                lo = max(lo, 0);
+                hi = min(hi, sizeX - 1);
+                live += countRow(y, z, lo, hi);
+                maxNeighbors += hi - lo + 1;
+            }
+        }
+    return maxNeighbors > 0 ? float(live) / float(maxNeighbors) : 0.0;
+}
+
+// Coloring::getShade
+int cellShade(ivec3 c)
+{
+    if (byDepth != 0)
+        return sizeZ > 1 ? int(float(c.z) / float(sizeZ - 1) * 255.0 + 0.5) : 0;
+    return int(clamp(computeDensity(c) / maxDensity, 0.0, 1.0) * 255.0 + 0.5);
+}
+
+void main()
+{
+    vec4 nearPoint = inverseViewProjection * vec4(vNdc, -1.0, 1.0);
+    vec4 farPoint = inverseViewProjection * vec4(vNdc, 1.0, 1.0);
+    vec3 origin = nearPoint.xyz / nearPoint.w - gridOrigin;
+    vec3 dir = normalize(farPoint.xyz / farPoint.w - nearPoint.xyz / nearPoint.w);
+    dir = mix(dir, vec3(1e-6), lessThan(abs(dir), vec3(1e-6)));
+    vec3 invDir = 1.0 / dir;
+
+    // Clip the ray to the grid's box
+    vec3 gridSize = vec3(sizeX, sizeY, sizeZ);
+    vec3 t0 = -origin * invDir;
+    vec3 t1 = (gridSize - origin) * invDir;
+    vec3 tNear = min(t0, t1), tFar = max(t0, t1);
+    float tEnter = max(max(tNear.x, max(tNear.y, tNear.z)), 0.0);
+    float tExit = min(tFar.x, min(tFar.y, tFar.z));
+    if (tEnter >= tExit) discard;
+
+    // March from the entry point so positions stay small and precise
+    vec3 start = origin + dir * tEnter;
+    float span = tExit - tEnter;
+    float t = 0.0;
+    int level = topLevel;  // -1 is single cells
+
+    for (int i = 0; i < maxSteps && t < span; ++i) {
+        vec3 p = start + dir * (t + kEpsilon);
+        if (any(lessThan(p, vec3(0.0))) || any(greaterThanEqual(p, gridSize))) break;
+
+        float size = level < 0 ? 1.0 : float(brick << level);
+        ivec3 c = ivec3(floor(p / size));
+        bool occupied = level < 0 ? getCell(c) : texelFetch(occupancy, c, level).r != 0u;
+
+        if (occupied) {
+            if (level >= 0) {
+                --level;
+                continue;
+            }
+            vec4 clip = viewProjection * vec4(start + dir * t + gridOrigin, 1.0);
+            gl_FragDepth = clip.z / clip.w * 0.5 + 0.5;
+            fragColor = vec4(texelFetch(palette, cellShade(c), 0).rgb, 1.0);
+            return;
+        }
+
+        // Step to where the ray leaves this texel
+        vec3 exitPlanes = (vec3(c) + step(0.0, dir)) * size;
+        vec3 tPlanes = (exitPlanes - start) * invDir;
+        float tNext = min(tPlanes.x, min(tPlanes.y, tPlanes.z));
+
+        // Climb when that also leaves the parent texel
+        if (level < topLevel) {
+            float parent = level < 0 ? float(brick) : size * 2.0;
+            vec3 q = start + dir * (tNext + kEpsilon);
+            if (ivec3(floor(q / parent)) != ivec3(floor(p / parent))) ++level;
+        }
+        t = max(tNext, t + kEpsilon);
+    }
+    discard;
+}
@@ -0,0 +1,11 @@
+#version 460 core
+
+// One triangle covering the screen; VolumeRenderer draws it without buffers
+out vec2 vNdc;
+
+void main()
+{
+    vec2 corner = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+    vNdc = corner * 2.0 - 1.0;
+    gl_Position = vec4(vNdc, 0.0, 1.0);
+}
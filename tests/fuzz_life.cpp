@@ -0,0 +1,420 @@
+// fuzz: differential test of every Life::update() kernel against a copy of
+// the original per-cell update. Runs random grids of awkward sizes through
+// each engine, thread count and slab size, in both boundary modes, and
+// stops at the first generation that is not bit-identical. Failures are
+// shrunk to the smallest grid and generation count that still fail.
+
+#include "Life.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The original Life::update(): one bool per cell, neighbors counted with
+// getCell(). Toric grids narrower than 3 count wrapped duplicates, exactly
+// like the optimized kernels must.
+class ReferenceLife {
+public:
+    ReferenceLife(int sizeX, int sizeY, int sizeZ)
+        : m_sizeX(sizeX), m_sizeY(sizeY), m_sizeZ(sizeZ),
+          m_grid(size_t(sizeX) * sizeY * sizeZ, false), m_next(m_grid.size(), false) {}
+
+    void setMode(LifeMode mode) { m_mode = mode; }
+    void setToric(bool toric) { m_toric = toric; }
+
+    bool getCell(int x, int y, int z) const {
+        if (m_toric) {
+            x = (x + m_sizeX) % m_sizeX;
+            y = (y + m_sizeY) % m_sizeY;
+            z = (z + m_sizeZ) % m_sizeZ;
+            return m_grid[index(x, y, z)];
+        }
+        return isValidPosition(x, y, z) ? m_grid[index(x, y, z)] : false;
+    }
+
+    void setCell(int x, int y, int z, bool state) {
+        if (isValidPosition(x, y, z)) m_grid[index(x, y, z)] = state;
+    }
+
+    void update() {
+        for (int z = 0; z < m_sizeZ; ++z)
+            for (int y = 0; y < m_sizeY; ++y)
+                for (int x = 0; x < m_sizeX; ++x) {
+                    bool alive = getCell(x, y, z);
+                    int n;
+                    switch (m_mode) {
+                        case LifeMode::Current3D:
+                            n = countNeighbors(x, y, z);
+                            m_next[index(x, y, z)] = alive ? (n == 5 || n == 6) : (n == 5);
+                            break;
+                        case LifeMode::Conway2D:
+                            n = countNeighbors2D(x, y, z);
+                            m_next[index(x, y, z)] = alive ? (n == 2 || n == 3) : (n == 3);
+                            break;
+                        case LifeMode::Custom3D:
+                            n = countNeighbors(x, y, z);
+                            m_next[index(x, y, z)] = alive ? (n >= 4 && n <= 6) : (n == 5);
+                            break;
+                        case LifeMode::Custom2D:
+                            n = countNeighbors2D(x, y, z);
+                            m_next[index(x, y, z)] = alive ? (n == 2 || n == 4) : (n == 3 || n == 6);
+                            break;
+                    }
+                }
+        std::swap(m_grid, m_next);
+    }
+
+private:
+    int m_sizeX, m_sizeY, m_sizeZ;
+    std::vector<bool> m_grid, m_next;
+    LifeMode m_mode = LifeMode::Current3D;
+    bool m_toric = false;
+
+    size_t index(int x, int y, int z) const {
+        return (size_t(z) * m_sizeY + y) * m_sizeX + x;
+    }
+
+    bool isValidPosition(int x, int y, int z) const {
+        return x >= 0 && x < m_sizeX && y >= 0 && y < m_sizeY && z >= 0 && z < m_sizeZ;
+    }
+
+    int countNeighbors(int x, int y, int z) const {
+        int count = 0;
+        for (int dz = -1; dz <= 1; ++dz)
+            for (int dy = -1; dy <= 1; ++dy)
+                for (int dx = -1; dx <= 1; ++dx) {
+                    if (dx == 0 && dy == 0 && dz == 0) continue;
+                    int nx = x + dx, ny = y + dy, nz = z + dz;
+                    if (m_toric) {
+                        nx = (nx + m_sizeX) % m_sizeX;
+                        ny = (ny + m_sizeY) % m_sizeY;
+                        nz = (nz + m_sizeZ) % m_sizeZ;
+                    }
+                    if (isValidPosition(nx, ny, nz) && getCell(nx, ny, nz)) count++;
+                }
+        return count;
+    }
+
+    int countNeighbors2D(int x, int y, int z) const {
+        int count = 0;
+        for (int dy = -1; dy <= 1; ++dy)
+            for (int dx = -1; dx <= 1; ++dx) {
+                if (dx == 0 && dy == 0) continue;
+                int nx = x + dx, ny = y + dy;
+                if (m_toric) {
+                    nx = (nx + m_sizeX) % m_sizeX;
+                    ny = (ny + m_sizeY) % m_sizeY;
+                }
+                if (isValidPosition(nx, ny, z) && getCell(nx, ny, z)) count++;
+            }
+        return count;
+    }
+};
+
+// One fully reproducible run: initial cells, configuration, and a batch of
+// edits applied after editAt generations (exercises sparse bookkeeping)
+struct FuzzCase {
+    int sizeX = 1, sizeY = 1, sizeZ = 1;
+    LifeMode mode = LifeMode::Current3D;
+    bool toric = false;
+    LifeEngine engine = LifeEngine::Auto;
+    int threads = 1;
+    int slabRows = 16;
+    int generations = 1;
+    int editAt = -1;
+    std::vector<CellEdit> initial; // live cells
+    std::vector<CellEdit> edits;
+
+    size_t cells() const { return size_t(sizeX) * sizeY * sizeZ; }
+};
+
+// Returns the first generation that differs from the reference, or -1.
+// sawSparse, if given, reports whether the run ever used the Sparse engine.
+int firstMismatch(const FuzzCase& c, bool* sawSparse = nullptr) {
+    ReferenceLife ref(c.sizeX, c.sizeY, c.sizeZ);
+    Life life(c.sizeX, c.sizeY, c.sizeZ);
+    ref.setMode(c.mode);
+    ref.setToric(c.toric);
+    life.setMode(c.mode);
+    life.setToric(c.toric);
+    life.setEngine(c.engine);
+    life.setThreadCount(c.threads);
+    life.setSlabRows(c.slabRows);
+
+    for (const CellEdit& e : c.initial) {
+        ref.setCell(e.x, e.y, e.z, e.alive);
+        life.setCell(e.x, e.y, e.z, e.alive);
+    }
+
+    for (int g = 1; g <= c.generations; ++g) {
+        if (g - 1 == c.editAt) {
+            for (const CellEdit& e : c.edits) ref.setCell(e.x, e.y, e.z, e.alive);
+            life.setCells(c.edits);
+        }
+
+        ref.update();
+        life.update();
+        if (sawSparse && life.getActiveEngine() == LifeEngine::Sparse) *sawSparse = true;
+
+        for (int z = 0; z < c.sizeZ; ++z)
+            for (int y = 0; y < c.sizeY; ++y)
+                for (int x = 0; x < c.sizeX; ++x)
+                    if (ref.getCell(x, y, z) != life.getCell(x, y, z))
+                        return g;
+    }
+    return -1;
+}
+
+std::vector<CellEdit> crop(const std::vector<CellEdit>& cells, int sizeX, int sizeY, int sizeZ) {
+    std::vector<CellEdit> kept;
+    for (const CellEdit& e : cells)
+        if (e.x < sizeX && e.y < sizeY && e.z < sizeZ) kept.push_back(e);
+    return kept;
+}
+
+// Greedily shrinks a failing case: fewer generations, smaller grid, fewer
+// cells and the simplest thread layout that still reproduces it
+FuzzCase shrink(FuzzCase c) {
+    c.generations = firstMismatch(c);
+
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        std::vector<FuzzCase> candidates;
+
+        for (int axis = 0; axis < 3; ++axis) {
+            int size = axis == 0 ? c.sizeX : axis == 1 ? c.sizeY : c.sizeZ;
+            for (int smaller : { size / 2, size - 1 }) {
+                if (smaller < 1 || smaller == size) continue;
+                FuzzCase t = c;
+                (axis == 0 ? t.sizeX : axis == 1 ? t.sizeY : t.sizeZ) = smaller;
+                t.initial = crop(c.initial, t.sizeX, t.sizeY, t.sizeZ);
+                t.edits = crop(c.edits, t.sizeX, t.sizeY, t.sizeZ);
+                candidates.push_back(t);
+            }
+        }
+        if (c.threads > 1) { FuzzCase t = c; t.threads = 1; candidates.push_back(t); }
+        if (!c.edits.empty()) { FuzzCase t = c; t.edits.clear(); t.editAt = -1; candidates.push_back(t); }
+        if (c.initial.size() <= 64)
+            for (size_t i = 0; i < c.initial.size(); ++i) {
+                FuzzCase t = c;
+                t.initial.erase(t.initial.begin() + i);
+                candidates.push_back(t);
+            }
+
+        for (FuzzCase& t : candidates) {
+            int g = firstMismatch(t);
+            if (g < 0) continue;
+            t.generations = g;
+            c = t;
+            progress = true;
+            break;
+        }
+    }
+    return c;
+}
+
+bool smallerThan(const FuzzCase& a, const FuzzCase& b) {
+    if (a.cells() != b.cells()) return a.cells() < b.cells();
+    return a.generations < b.generations;
+}
+
+void describe(const FuzzCase& c) {
+    std::cout << c.sizeX << "x" << c.sizeY << "x" << c.sizeZ << " " << Life::modeName(c.mode)
+              << (c.toric ? " toric" : "") << ", engine " << Life::engineName(c.engine)
+              << ", " << c.threads << " thread(s), " << c.slabRows << " rows per slab"
+              << ", differs at generation " << c.generations << "\n";
+
+    if (c.editAt >= 0 && !c.edits.empty())
+        std::cout << c.edits.size() << " edit(s) before generation " << c.editAt + 1 << "\n";
+
+    if (c.cells() > 4096) return;
+    Life initial(c.sizeX, c.sizeY, c.sizeZ);
+    for (const CellEdit& e : c.initial) initial.setCell(e.x, e.y, e.z, e.alive);
+    std::cout << "Initial state:\n";
+    for (int z = 0; z < c.sizeZ; ++z) {
+        std::cout << "L" << z << "\n";
+        for (int y = 0; y < c.sizeY; ++y) {
+            for (int x = 0; x < c.sizeX; ++x) std::cout << (initial.getCell(x, y, z) ? '1' : '0');
+            std::cout << "\n";
+        }
+    }
+}
+
+// Still debris (2x2 blocks) with one blinker, on grids big enough for Auto
+// to settle on Sparse; a second blinker is drawn in after the switch so the
+// change list also has to pick up an edit
+FuzzCase debrisCase(int sizeX, int sizeY, int sizeZ, bool toric, int generations) {
+    FuzzCase c;
+    c.sizeX = sizeX;
+    c.sizeY = sizeY;
+    c.sizeZ = sizeZ;
+    c.mode = LifeMode::Conway2D;
+    c.toric = toric;
+    c.generations = generations;
+    for (int z = 0; z < sizeZ; z += 2)
+        for (int y = 1; y + 2 < sizeY; y += 9)
+            for (int x = 1; x + 2 < sizeX; x += 11)
+                for (int i = 0; i < 4; ++i) c.initial.push_back({ x + i % 2, y + i / 2, z, true });
+    for (int i = 0; i < 3; ++i) c.initial.push_back({ 5 + i, 6, 1, true });
+    c.editAt = generations / 2;
+    for (int i = 0; i < 3; ++i) c.edits.push_back({ sizeX - 8 + i, sizeY - 4, sizeZ - 1, true });
+    return c;
+}
+
+// Odd sizes on purpose: single cells and planes, primes, and widths just
+// around the 64-bit word boundary
+int randomExtent(std::mt19937_64& rng, bool wide) {
+    static const int primes[] = { 2, 3, 5, 7, 11, 13, 17, 31, 61, 67, 127, 131 };
+    static const int edges[] = { 1, 63, 64, 65, 127, 128, 129 };
+    switch (rng() % (wide ? 4 : 3)) {
+        case 0:  return 1;
+        case 1:  return primes[rng() % (wide ? 12 : 6)];
+        case 2:  return 1 + int(rng() % (wide ? 40 : 9));
+        default: return edges[rng() % 7];
+    }
+}
+
+void printUsage() {
+    std::cout <<
+        "Usage: fuzz [options]\n"
+        "  --cases N         Random grids to try (default 2000).\n"
+        "  --generations N   Generations per run (default 24).\n"
+        "  --seed N          Random seed (default 1).\n";
+}
+
+// The whole of text as a decimal number in minimum..maximum
+bool parseNumber(const std::string& text, long long minimum, long long maximum, long long& number) {
+    const char* start = text.c_str();
+    char* stop = nullptr;
+    errno = 0;
+    long long parsed = std::strtoll(start, &stop, 10);
+    if (stop == start || *stop != '\0' || errno == ERANGE || parsed < minimum || parsed > maximum)
+        return false;
+    number = parsed;
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int cases = 2000, generations = 24; // past kSwitchStreak, so Auto gets to switch
+    uint64_t seed = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto number = [&](long long minimum, long long maximum) -> long long {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << "\n";
+                printUsage();
+                std::exit(2);
+            }
+            std::string text = argv[++i];
+            long long parsed = 0;
+            if (!parseNumber(text, minimum, maximum, parsed)) {
+                std::cerr << "Invalid value for " << arg << ": " << text << "\n";
+                printUsage();
+                std::exit(2);
+            }
+            return parsed;
+        };
+
+        if (arg == "--help" || arg == "-h") { printUsage(); return 0; }
+        else if (arg == "--cases") cases = int(number(0, INT_MAX));
+        else if (arg == "--generations") generations = int(number(1, INT_MAX));
+        else if (arg == "--seed") seed = uint64_t(number(0, LLONG_MAX));
+        else {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            printUsage();
+            return 2;
+        }
+    }
+
+    const LifeEngine engines[] = { LifeEngine::Dense, LifeEngine::Bitsliced, LifeEngine::Sparse, LifeEngine::Auto };
+    const int threadCounts[] = { 1, 2, 3, 4, 7 };
+    const int slabSizes[] = { 1, 2, 3, 5, 16 };
+
+    std::mt19937_64 rng(seed);
+    long long runs = 0, failures = 0;
+    bool haveFailure = false;
+    FuzzCase smallest;
+
+    // Fixed runs that must reach Sparse under Auto and stay exact after it
+    const int debrisSizes[][3] = { { 64, 32, 16 }, { 130, 40, 8 }, { 200, 200, 2 } };
+    for (const auto& size : debrisSizes)
+        for (bool toric : { false, true })
+            for (int threads : { 1, 4 }) {
+                FuzzCase c = debrisCase(size[0], size[1], size[2], toric, 48);
+                c.threads = threads;
+                bool sawSparse = false;
+                int mismatch = firstMismatch(c, &sawSparse);
+                ++runs;
+                if (mismatch < 0 && sawSparse) continue;
+
+                ++failures;
+                if (mismatch < 0) {
+                    std::cout << "Auto never switched to Sparse on " << c.sizeX << "x" << c.sizeY << "x" << c.sizeZ
+                              << (toric ? " toric" : "") << " debris with " << threads << " thread(s)\n";
+                    continue;
+                }
+                c.generations = mismatch;
+                if (!haveFailure || smallerThan(c, smallest)) smallest = c;
+                haveFailure = true;
+            }
+
+    for (int n = 0; n < cases; ++n) {
+        FuzzCase base;
+        base.sizeX = randomExtent(rng, true);
+        base.sizeY = randomExtent(rng, false);
+        base.sizeZ = randomExtent(rng, false);
+        base.mode = LifeMode(rng() % 4);
+        base.generations = generations;
+
+        // Density from nearly empty to nearly full
+        int permille = int(rng() % 600);
+        for (int z = 0; z < base.sizeZ; ++z)
+            for (int y = 0; y < base.sizeY; ++y)
+                for (int x = 0; x < base.sizeX; ++x)
+                    if (int(rng() % 1000) < permille) base.initial.push_back({ x, y, z, true });
+
+        base.editAt = int(rng() % generations);
+        int editCount = int(rng() % 8);
+        for (int e = 0; e < editCount; ++e)
+            base.edits.push_back({ int(rng() % base.sizeX), int(rng() % base.sizeY),
+                                   int(rng() % base.sizeZ), rng() % 2 == 0 });
+
+        for (bool toric : { false, true })
+            for (LifeEngine engine : engines) {
+                FuzzCase c = base;
+                c.toric = toric;
+                c.engine = engine;
+                c.threads = threadCounts[rng() % 5];
+                c.slabRows = slabSizes[rng() % 5];
+
+                ++runs;
+                if (firstMismatch(c) < 0) continue;
+
+                ++failures;
+                FuzzCase shrunk = shrink(c);
+                if (!haveFailure || smallerThan(shrunk, smallest)) smallest = shrunk;
+                haveFailure = true;
+            }
+
+        if ((n + 1) % 250 == 0)
+            std::cout << (n + 1) << "/" << cases << " grids, " << failures << " failure(s)" << std::endl;
+    }
+
+    std::cout << runs << " runs, " << failures << " failure(s)\n";
+    if (!haveFailure) return failures > 0 ? 1 : 0;
+
+    std::cout << "Smallest failing case: ";
+    describe(smallest);
+    return 1;
+}
@@ -1,10 +1,22 @@
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 #include "Life.h"
+#include "Simulation.h"
+#include "TripleBuffer.h"
+#include "Profiler.h"
+#include "LifeLog.h"
+#include "AsyncLogWriter.h"
+#include "LogReplay.h"
+#include "Checkpoint.h"
+#include "WorkerPool.h"
+#include <atomic>
 #include <cstdio>    // for std::remove
 #include <fstream>
 #include <iostream>
 #include <filesystem>
+#include <thread>
+#include <chrono>
+#include <sstream>
 
 TEST_CASE("Life grid initialization and size") {
     std::cout << "[TEST] Grid initialization and size" << std::endl;
@@ -130,3 +142,812 @@ TEST_CASE("Life save and load") {
     std::filesystem::remove_all(ioDir);
     std::cout << " - Temporary files cleaned." << std::endl;
 }
+
+TEST_CASE("Life engines produce identical generations") {
+    std::cout << "[TEST] Engines produce identical generations" << std::endl;
+
+    const LifeMode modes[] = { LifeMode::Current3D, LifeMode::Conway2D, LifeMode::Custom3D, LifeMode::Custom2D };
+    const LifeEngine engines[] = { LifeEngine::Dense, LifeEngine::Bitsliced, LifeEngine::Sparse, LifeEngine::Auto };
+
+    for (LifeMode mode : modes)
+        for (bool toric : { false, true }) {
+            std::vector<Life> lives;
+            for (LifeEngine engine : engines) {
+                Life life(67, 5, 4);
+                life.setMode(mode);
+                life.setToric(toric);
+                life.setEngine(engine);
+                life.setThreadCount(engine == LifeEngine::Bitsliced ? 3 : 1);
+                life.setSlabRows(2);
+                for (int z = 0; z < 4; ++z)
+                    for (int y = 0; y < 5; ++y)
+                        for (int x = 0; x < 67; ++x)
+                            life.setCell(x, y, z, (x * 7 + y * 13 + z * 29) % 5 < 2);
+                lives.push_back(life);
+            }
+
+            for (int step = 0; step < 5; ++step) {
+                for (auto& life : lives) life.update();
+                for (size_t i = 1; i < lives.size(); ++i)
+                    REQUIRE(lives[i].getWords() == lives[0].getWords());
+            }
+        }
+}
+
+TEST_CASE("Life adaptive engine settles on sparse for still debris") {
+    std::cout << "[TEST] Adaptive engine selection" << std::endl;
+    Life life(256, 64, 1);
+    life.setMode(LifeMode::Conway2D);
+    REQUIRE(life.getEngine() == LifeEngine::Auto);
+    REQUIRE(life.getActiveEngine() == LifeEngine::Bitsliced);
+
+    // A 2x2 block never changes
+    life.setCell(10, 10, 0, true);
+    life.setCell(11, 10, 0, true);
+    life.setCell(10, 11, 0, true);
+    life.setCell(11, 11, 0, true);
+
+    for (int step = 0; step < 20; ++step)
+        life.update();
+
+    REQUIRE(life.getActiveEngine() == LifeEngine::Sparse);
+    REQUIRE(life.getEngineHistory().size() == 1);
+    REQUIRE(life.getEngineHistory()[0].to == LifeEngine::Sparse);
+    REQUIRE(life.getPopulation() == 4);
+    REQUIRE(life.getGeneration() == 20);
+
+    // An edit after the switch is still picked up: the blinker oscillates
+    life.setCell(30, 5, 0, true);
+    life.setCell(31, 5, 0, true);
+    life.setCell(32, 5, 0, true);
+    life.update();
+    REQUIRE(life.getCell(31, 4, 0) == true);
+    REQUIRE(life.getCell(31, 6, 0) == true);
+    REQUIRE(life.getCell(30, 5, 0) == false);
+    REQUIRE(life.getPopulation() == 7);
+
+    // Too few words to be worth tracking: the same block stays on a full kernel
+    Life small(64, 16, 1);
+    small.setMode(LifeMode::Conway2D);
+    small.setCell(10, 10, 0, true);
+    small.setCell(11, 10, 0, true);
+    small.setCell(10, 11, 0, true);
+    small.setCell(11, 11, 0, true);
+    for (int step = 0; step < 20; ++step)
+        small.update();
+    REQUIRE(small.getActiveEngine() == LifeEngine::Bitsliced);
+
+    // Still but crowded (blocks one cell apart): no switch either
+    Life crowded(256, 64, 1);
+    crowded.setMode(LifeMode::Conway2D);
+    for (int y = 0; y + 1 < 64; y += 3)
+        for (int x = 0; x + 1 < 256; x += 3)
+            for (int c = 0; c < 4; ++c)
+                crowded.setCell(x + c % 2, y + c / 2, 0, true);
+    for (int step = 0; step < 20; ++step)
+        crowded.update();
+    REQUIRE(crowded.getChangedCells() == 0);
+    REQUIRE(crowded.getActiveEngine() == LifeEngine::Bitsliced);
+    REQUIRE(crowded.getEngineHistory().empty());
+}
+
+TEST_CASE("Life loads a tuning profile") {
+    std::cout << "[TEST] Load tuning profile" << std::endl;
+
+    const std::string path = "test_machine.profile";
+    std::ofstream out(path);
+    out << "# test profile\n";
+    out << "kernel=dense\n";
+    out << "threads=3\n";
+    out << "slabRows=8\n";
+    out.close();
+
+    Life life(32, 4, 4);
+    REQUIRE(life.loadProfile(path) == true);
+    REQUIRE(life.getTunedKernel() == LifeEngine::Dense);
+    REQUIRE(life.getActiveEngine() == LifeEngine::Dense);
+    REQUIRE(life.getThreadCount() == 3);
+    REQUIRE(life.getSlabRows() == 8);
+
+    REQUIRE(life.loadProfile("missing.profile") == false);
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("TripleBuffer hands the reader the newest published value") {
+    std::cout << "[TEST] Triple buffer" << std::endl;
+    TripleBuffer<int> buffer;
+
+    buffer.back() = 1;
+    buffer.publish();
+    buffer.back() = 2;
+    buffer.publish();
+    REQUIRE(buffer.acquire() == 2);
+
+    // Nothing new: the reader keeps its value while the writer moves on
+    buffer.back() = 3;
+    REQUIRE(buffer.acquire() == 2);
+    buffer.publish();
+    REQUIRE(buffer.acquire() == 3);
+}
+
+TEST_CASE("WorkerPool reuses its threads from run to run") {
+    std::cout << "[TEST] Worker pool" << std::endl;
+    WorkerPool pool;
+    std::atomic<int> calls{0};
+
+    for (int round = 0; round < 200; ++round)
+        pool.run(4, [&]() { ++calls; });
+    REQUIRE(calls == 800);
+    REQUIRE(pool.getThreadCount() == 3);
+
+    // Fewer workers leave the extra threads parked; a copy starts its own
+    pool.run(2, [&]() { ++calls; });
+    REQUIRE(calls == 802);
+    REQUIRE(pool.getThreadCount() == 3);
+    WorkerPool copy = pool;
+    REQUIRE(copy.getThreadCount() == 0);
+    copy.run(3, [&]() { ++calls; });
+    REQUIRE(calls == 805);
+    REQUIRE(copy.getThreadCount() == 2);
+}
+
+TEST_CASE("Simulation publishes snapshots of each change") {
+    std::cout << "[TEST] Simulation snapshots" << std::endl;
+    Life life(8, 8, 1);
+    life.setMode(LifeMode::Conway2D);
+    Simulation simulation(life);
+    simulation.setSpeed(0.f);
+    simulation.start();
+
+    simulation.post(Command::setCells({ { 2, 3, 0, true }, { 3, 3, 0, true }, { 4, 3, 0, true } }));
+    simulation.waitForCommands();
+    const LifeSnapshot& before = simulation.latest();
+    REQUIRE(before.getPopulation() == 3);
+    REQUIRE(before.getCell(3, 3, 0) == true);
+    REQUIRE(before.getCell(3, 2, 0) == false);
+
+    simulation.post(Command::step());
+    simulation.waitForCommands();
+    const LifeSnapshot& after = simulation.latest();
+    REQUIRE(after.getGeneration() == 1);
+    REQUIRE(after.getCell(3, 2, 0) == true);
+    REQUIRE(after.getCell(2, 3, 0) == false);
+
+    simulation.stop();
+}
+
+TEST_CASE("Simulation applies commands posted from several threads") {
+    std::cout << "[TEST] Command queue" << std::endl;
+    Life life(100, 100, 4);
+    Simulation simulation(life);
+    simulation.setSpeed(0.f);
+    simulation.start();
+
+    // Four producers, 10,000 edits in batches of 100
+    std::vector<std::thread> producers;
+    for (int z = 0; z < 4; ++z)
+        producers.emplace_back([&simulation, z]() {
+            for (int y = 0; y < 25; ++y) {
+                std::vector<CellEdit> edits;
+                for (int x = 0; x < 100; ++x)
+                    edits.push_back({ x, y * 4 + z, z, true });
+                simulation.post(Command::setCells(std::move(edits)));
+            }
+        });
+    for (auto& t : producers) t.join();
+
+    simulation.post(Command::setMode(LifeMode::Conway2D));
+    simulation.waitForCommands();
+
+    const LifeSnapshot& snapshot = simulation.latest();
+    REQUIRE(snapshot.getPopulation() == 10000);
+    REQUIRE(snapshot.getMode() == LifeMode::Conway2D);
+
+    simulation.stop();
+}
+
+TEST_CASE("Simulation max throughput runs back-to-back generations") {
+    std::cout << "[TEST] Max throughput" << std::endl;
+    Life life(16, 16, 16);
+    Simulation simulation(life);
+    simulation.setSpeed(0.f);
+    simulation.setMaxThroughput(true);
+    simulation.start();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(700));
+    simulation.setMaxThroughput(false);
+    simulation.post(Command::run([](Life&) {}));
+    simulation.waitForCommands();
+
+    // A 0.5 s interval would allow one generation at most
+    REQUIRE(simulation.latest().getGeneration() > 10);
+    REQUIRE(simulation.getGenerationsPerSecond() > 10.f);
+
+    simulation.stop();
+}
+
+TEST_CASE("Life export round-trips through loadFromFile") {
+    std::cout << "[TEST] Export and reload" << std::endl;
+
+    LifeMode mode;
+    REQUIRE(Life::parseMode("Conway2D", mode) == true);
+    REQUIRE(mode == LifeMode::Conway2D);
+    REQUIRE(Life::parseMode("Bogus", mode) == false);
+
+    int x = 0, y = 0, z = 0;
+    REQUIRE(Life::parseDims("4x5x6", x, y, z) == true);
+    REQUIRE((x == 4 && y == 5 && z == 6));
+    REQUIRE(Life::parseDims("axbxc", x, y, z) == false);
+    REQUIRE(Life::parseDims("10x10x", x, y, z) == false);
+    REQUIRE(Life::parseDims("0x10x10", x, y, z) == false);
+
+    Life life(70, 3, 2);
+    life.setCell(0, 0, 0, true);
+    life.setCell(69, 2, 1, true);
+    life.setCell(64, 1, 0, true);
+    REQUIRE(life.exportToFile("IO/export_test/initial.txt", "export_test") == true);
+
+    Life loaded(1, 1, 1);
+    REQUIRE(loaded.loadFromFile("export_test") == true);
+    REQUIRE(loaded.getSizeX() == 70);
+    REQUIRE(loaded.getWords() == life.getWords());
+
+    std::filesystem::remove_all("IO/export_test");
+}
+
+TEST_CASE("Life seeded randomize is reproducible and respects density") {
+    std::cout << "[TEST] Seeded randomize" << std::endl;
+    Life a(100, 50, 20), b(100, 50, 20);
+    a.randomize(0.1f, 42);
+    b.randomize(0.1f, 42);
+    REQUIRE(a.getWords() == b.getWords());
+
+    double density = double(a.getPopulation()) / (100.0 * 50.0 * 20.0);
+    REQUIRE(density > 0.09);
+    REQUIRE(density < 0.11);
+
+    // Padding bits past sizeX stay clear
+    a.randomize(1.0f, 1);
+    REQUIRE(a.getPopulation() == 100u * 50u * 20u);
+}
+
+TEST_CASE("Profiler exports zones from several threads as a Chrome trace") {
+    std::cout << "[TEST] Profiler trace" << std::endl;
+    Profiler::setThreadName("test"); // claim a ring before the workers can hand theirs back
+    Profiler::clear();
+
+    auto work = [](const char* thread) {
+        Profiler::setThreadName(thread);
+        for (int i = 0; i < 100; ++i) {
+            int64_t start = Profiler::now();
+            Profiler::record("zone", start, start + 1000);
+        }
+    };
+    std::thread a(work, "worker-a");
+    std::thread b(work, "worker-b");
+    a.join();
+    b.join();
+
+    // Lapping the ring keeps only the newest events
+    for (size_t i = 0; i < Profiler::kRingSize + 10; ++i)
+        Profiler::record("lap", 0, 1);
+
+    REQUIRE(Profiler::writeChromeTrace("profile_test.json") == true);
+    std::ifstream in("profile_test.json");
+    std::stringstream text;
+    text << in.rdbuf();
+    std::string trace = text.str();
+    in.close();
+
+    auto count = [&](const std::string& needle) {
+        size_t n = 0;
+        for (size_t pos = trace.find(needle); pos != std::string::npos; pos = trace.find(needle, pos + 1)) ++n;
+        return n;
+    };
+    REQUIRE(trace.rfind("{\"displayTimeUnit\"", 0) == 0);
+    REQUIRE(count("\"name\":\"zone\"") == 200);
+    REQUIRE(count("\"name\":\"lap\"") == Profiler::kRingSize - 1);
+    REQUIRE(count("\"worker-a\"") + count("\"worker-b\"") >= 1);
+    REQUIRE(trace.find("\"dur\":1.000") != std::string::npos);
+
+    Profiler::clear();
+    std::remove("profile_test.json");
+}
+
+TEST_CASE("Life binary snapshots round-trip and reject corrupt files") {
+    std::cout << "[TEST] Binary snapshot" << std::endl;
+
+    Life life(70, 5, 3);
+    life.setMode(LifeMode::Custom3D);
+    life.setToric(true);
+    life.randomize(0.3f, 99);
+    life.update();
+    life.update();
+    REQUIRE(life.saveBinary("snapshot_test.lifb") == true);
+
+    // Header plus one bit per cell, padded to whole words per row
+    REQUIRE(std::filesystem::file_size("snapshot_test.lifb") == 64 + 2 * 5 * 3 * 8);
+
+    Life loaded(1, 1, 1);
+    REQUIRE(loaded.loadBinary("snapshot_test.lifb") == true);
+    REQUIRE(loaded.getSizeX() == 70);
+    REQUIRE(loaded.getMode() == LifeMode::Custom3D);
+    REQUIRE(loaded.isToric() == true);
+    REQUIRE(loaded.getGeneration() == 2);
+    REQUIRE(loaded.getPopulation() == life.getPopulation());
+    REQUIRE(loaded.getWords() == life.getWords());
+
+    life.update();
+    loaded.update();
+    REQUIRE(loaded.getWords() == life.getWords());
+
+    // Flip one payload bit: the checksum catches it and the grid is kept
+    {
+        std::fstream f("snapshot_test.lifb", std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(64 + 3);
+        f.put('\x5a');
+    }
+    Life corrupt(4, 4, 4);
+    REQUIRE(corrupt.loadBinary("snapshot_test.lifb") == false);
+    REQUIRE(corrupt.getSizeX() == 4);
+
+    // Truncated file
+    std::filesystem::resize_file("snapshot_test.lifb", 100);
+    REQUIRE(corrupt.loadBinary("snapshot_test.lifb") == false);
+
+    std::remove("snapshot_test.lifb");
+}
+
+TEST_CASE("Life logs binary generations without console echo") {
+    std::cout << "[TEST] Binary log" << std::endl;
+
+    Life life(8, 8, 8);
+    life.randomize(0.4f, 5);
+    REQUIRE(life.getConsoleEcho() == false);
+    REQUIRE(life.saveToFile("binary_log_test", 0) == true);
+
+    Life loaded(1, 1, 1);
+    REQUIRE(loaded.loadBinary("IO/binary_log_test/log/00000.lifb") == true);
+    REQUIRE(loaded.getWords() == life.getWords());
+
+    std::filesystem::remove_all("IO/binary_log_test");
+}
+
+TEST_CASE("LifeLog reconstructs any generation from keyframes and deltas") {
+    std::cout << "[TEST] Delta log" << std::endl;
+
+    // Three gliders on 256x64x4: a few words change per generation
+    Life life(256, 64, 4);
+    life.setMode(LifeMode::Conway2D);
+    for (int z = 0; z < 3; ++z) {
+        int ox = 10 + 80 * z, oy = 5 + 10 * z;
+        life.setCell(ox + 1, oy, z, true);
+        life.setCell(ox + 2, oy + 1, z, true);
+        life.setCell(ox, oy + 2, z, true);
+        life.setCell(ox + 1, oy + 2, z, true);
+        life.setCell(ox + 2, oy + 2, z, true);
+    }
+
+    LifeLogWriter writer;
+    REQUIRE(writer.open("log_test.lifl", 256, 64, 4, 8) == true);
+
+    std::vector<std::vector<uint64_t>> frames;
+    for (int g = 0; g < 40; ++g) {
+        if (g == 20) life.setToric(true);
+        REQUIRE(writer.append(life) == true);
+        frames.push_back(life.getWords());
+        life.update();
+    }
+    REQUIRE(writer.getFrameCount() == 40);
+
+    // Well over an order of magnitude below full copies, keyframes included
+    uint64_t fullCopies = 40ull * life.getWords().size() * 8;
+    REQUIRE(writer.getBytesWritten() < fullCopies / 50);
+
+    Life wrongSize(10, 10, 10);
+    REQUIRE(writer.append(wrongSize) == false);
+    writer.close();
+
+    LifeLogReader reader;
+    REQUIRE(reader.open("log_test.lifl") == true);
+    REQUIRE(reader.getFrameCount() == 40);
+    REQUIRE(reader.getKeyframeInterval() == 8);
+
+    // Out of order, forward within a run of deltas, and across keyframes
+    Life replay(1, 1, 1);
+    for (size_t frame : { 39, 0, 5, 6, 7, 8, 21, 3, 39, 38 }) {
+        REQUIRE(reader.read(frame, replay) == true);
+        REQUIRE(replay.getWords() == frames[frame]);
+        REQUIRE(replay.getGeneration() == (long long)frame);
+        REQUIRE(replay.isToric() == (frame >= 20));
+    }
+    reader.close();
+
+    // A frame cut short by a crash ends the log without failing it
+    std::filesystem::resize_file("log_test.lifl", std::filesystem::file_size("log_test.lifl") - 3);
+    REQUIRE(reader.open("log_test.lifl") == true);
+    REQUIRE(reader.getFrameCount() == 39);
+    reader.close();
+
+    // A chaotic soup falls back to whole-grid frames: never much bigger
+    // than full copies, and still exact
+    Life soup(100, 20, 6);
+    soup.randomize(0.3f, 17);
+    REQUIRE(writer.open("log_test.lifl", 100, 20, 6, 4) == true);
+    std::vector<std::vector<uint64_t>> soupFrames;
+    for (int g = 0; g < 10; ++g) {
+        REQUIRE(writer.append(soup) == true);
+        soupFrames.push_back(soup.getWords());
+        soup.update();
+    }
+    REQUIRE(writer.getBytesWritten() < 10ull * soup.getWords().size() * 8 + 32 + 10 * 16);
+    writer.close();
+
+    REQUIRE(reader.open("log_test.lifl") == true);
+    for (size_t frame = 0; frame < 10; ++frame) {
+        REQUIRE(reader.read(frame, replay) == true);
+        REQUIRE(replay.getWords() == soupFrames[frame]);
+    }
+    reader.close();
+
+    std::remove("log_test.lifl");
+    std::remove("log_test.lifl.idx");
+}
+
+TEST_CASE("AsyncLogWriter writes, drops or coalesces when its queue is full") {
+    std::cout << "[TEST] Async log writer" << std::endl;
+
+    Life life(128, 32, 8);
+    life.randomize(0.2f, 3);
+    auto snapshotOf = [](const Life& l) {
+        auto s = std::make_shared<LifeSnapshot>();
+        l.snapshot(*s);
+        return std::shared_ptr<const LifeSnapshot>(s);
+    };
+
+    for (LogFullPolicy policy : { LogFullPolicy::Block, LogFullPolicy::Drop, LogFullPolicy::Coalesce }) {
+        AsyncLogWriter writer(2, policy);
+        REQUIRE(writer.submit(snapshotOf(life)) == false); // nothing open yet
+
+        // A directory cannot be a log; open() reports it instead of the writer thread
+        REQUIRE(writer.open(".", 128, 32, 8, 4) == false);
+        REQUIRE(writer.isOpen() == false);
+        REQUIRE(writer.submit(snapshotOf(life)) == false);
+
+        REQUIRE(writer.open("async_test.lifl", 128, 32, 8, 4) == true);
+        Life run = life;
+        for (int g = 0; g < 60; ++g) {
+            writer.submit(snapshotOf(run));
+            run.update();
+        }
+        writer.flush();
+
+        REQUIRE(writer.getPending() == 0);
+        REQUIRE(writer.getQueued() + writer.getDropped() == 60);
+        REQUIRE(writer.getWritten() + writer.getCoalesced() == writer.getQueued());
+        if (policy == LogFullPolicy::Block) REQUIRE(writer.getWritten() == 60);
+
+        LifeLogReader reader;
+        REQUIRE(reader.open("async_test.lifl") == true);
+        REQUIRE(reader.getFrameCount() == writer.getWritten());
+
+        // Whatever was skipped, frames stay in order and decode exactly
+        Life replay(1, 1, 1), expected = life;
+        long long previous = -1;
+        for (size_t f = 0; f < reader.getFrameCount(); ++f) {
+            REQUIRE(reader.read(f, replay) == true);
+            REQUIRE(replay.getGeneration() > previous);
+            while (expected.getGeneration() < replay.getGeneration()) expected.update();
+            REQUIRE(replay.getWords() == expected.getWords());
+            previous = replay.getGeneration();
+        }
+        // Coalesce always keeps the newest snapshot
+        if (policy != LogFullPolicy::Drop) REQUIRE(previous == 59);
+        reader.close();
+
+        // Closing stops submit() at once, before the writer reaches the Close
+        uint64_t queued = writer.getQueued();
+        writer.close();
+        REQUIRE(writer.submit(snapshotOf(run)) == false);
+        writer.flush();
+        REQUIRE(writer.getQueued() == queued);
+    }
+
+    LogFullPolicy parsed;
+    REQUIRE(AsyncLogWriter::parsePolicy("Coalesce", parsed) == true);
+    REQUIRE(parsed == LogFullPolicy::Coalesce);
+    REQUIRE(AsyncLogWriter::parsePolicy("later", parsed) == false);
+
+    std::remove("async_test.lifl");
+    std::remove("async_test.lifl.idx");
+}
+
+TEST_CASE("Life loads layered text straight into packed words") {
+    std::cout << "[TEST] Mapped text loader" << std::endl;
+
+    std::filesystem::create_directories("IO/loader_test");
+    std::string wide(70, '0');
+    wide[0] = wide[64] = wide[69] = '1';
+    {
+        std::ofstream out("IO/loader_test/initial.txt", std::ios::binary);
+        out << "loader_test\n70x3x3\n"
+            << "ignored before any layer\n"
+            << "L2\n" << wide << "\n\n" << "01\n"        // blank lines are not rows
+            << "L7\n" << wide << "\n"                    // layer out of range
+            << "L0\n" << "1x1\n" << "0000000011\r\n"     // other characters keep the cell
+            << "L0\n" << "0\n"                           // a repeated layer overwrites
+            << "L1\n" << wide;                           // no final newline
+    }
+
+    Life life(1, 1, 1);
+    REQUIRE(life.loadFromFile("loader_test") == true);
+    REQUIRE(life.getSizeX() == 70);
+    REQUIRE(life.getLastLoad().bytes == std::filesystem::file_size("IO/loader_test/initial.txt"));
+    REQUIRE(life.getLastLoad().layers == 3);
+
+    REQUIRE(life.getCell(0, 0, 2) == true);
+    REQUIRE(life.getCell(64, 0, 2) == true);
+    REQUIRE(life.getCell(69, 0, 2) == true);
+    REQUIRE(life.getCell(1, 1, 2) == true);
+    REQUIRE(life.getCell(0, 0, 0) == false);  // overwritten by the second L0
+    REQUIRE(life.getCell(2, 0, 0) == true);   // past the overwriting row: kept
+    REQUIRE(life.getCell(8, 1, 0) == true);
+    REQUIRE(life.getCell(9, 1, 0) == true);
+    REQUIRE(life.getCell(69, 0, 1) == true);
+    REQUIRE(life.getPopulation() == 10);
+
+    std::filesystem::remove_all("IO/loader_test");
+}
+
+TEST_CASE("Life reads and writes RLE patterns in 2D and 3D") {
+    std::cout << "[TEST] RLE import/export" << std::endl;
+
+    std::filesystem::create_directories("IO/rle_test");
+    {
+        std::ofstream out("IO/rle_test/glider.rle");
+        out << "#N Glider\n#C A comment\nx = 3, y = 3, rule = B3/S23\nbob$2b\no$3o!\n";
+    }
+    Life life(1, 1, 1);
+    REQUIRE(life.loadRLE("IO/rle_test/glider.rle") == true);
+    REQUIRE(life.getSizeX() == 3);
+    REQUIRE(life.getSizeY() == 3);
+    REQUIRE(life.getSizeZ() == 1);
+    REQUIRE(life.getMode() == LifeMode::Conway2D);
+    REQUIRE(life.isToric() == false);
+    REQUIRE(life.getPopulation() == 5);
+    REQUIRE(life.getCell(1, 0, 0) == true);
+    REQUIRE(life.getCell(2, 1, 0) == true);
+    REQUIRE(life.getCell(0, 2, 0) == true);
+    REQUIRE(life.getCell(2, 2, 0) == true);
+
+    // Sparse layered pattern: runs, blank rows and planes never expand
+    {
+        std::ofstream out("IO/rle_test/sparse.rle");
+        out << "x = 20000, y = 300, z = 40, rule = B5/S56:T20000,300,40\n"
+            << "19998b2o299$70o39/5$3bo!\n";
+    }
+    REQUIRE(life.loadRLE("IO/rle_test/sparse.rle") == true);
+    REQUIRE(life.getSizeX() == 20000);
+    REQUIRE(life.getSizeZ() == 40);
+    REQUIRE(life.getMode() == LifeMode::Current3D);
+    REQUIRE(life.isToric() == true);
+    REQUIRE(life.getPopulation() == 73);
+    REQUIRE(life.getCell(19999, 0, 0) == true);
+    REQUIRE(life.getCell(69, 299, 0) == true);
+    REQUIRE(life.getCell(3, 5, 39) == true);
+
+    // Round trip of a random grid keeps every word, the rule and boundary
+    Life original(131, 17, 5);
+    original.randomize(0.3f, 7);
+    original.setMode(LifeMode::Custom2D);
+    original.setToric(true);
+    original.setCell(0, 4, 2, false);
+    for (int x = 0; x < 131; ++x) original.setCell(x, 6, 3, x % 70 != 0);
+    for (int y = 0; y < 17; ++y)
+        for (int x = 0; x < 131; ++x) original.setCell(x, y, 1, false);
+    REQUIRE(original.saveRLE("IO/rle_test/round.rle", "round") == true);
+
+    Life loaded(1, 1, 1);
+    REQUIRE(loaded.loadRLE("IO/rle_test/round.rle") == true);
+    REQUIRE(loaded.getWords() == original.getWords());
+    REQUIRE(loaded.getMode() == LifeMode::Custom2D);
+    REQUIRE(loaded.isToric() == true);
+
+    std::ifstream written("IO/rle_test/round.rle");
+    std::string line;
+    while (std::getline(written, line)) REQUIRE(line.size() <= 70);
+
+    // Cells past the header size are clipped, unknown characters rejected
+    {
+        std::ofstream out("IO/rle_test/bad.rle");
+        out << "x = 2, y = 1\n5o$o!\n";
+    }
+    REQUIRE(loaded.loadRLE("IO/rle_test/bad.rle") == true);
+    REQUIRE(loaded.getPopulation() == 2);
+    {
+        std::ofstream out("IO/rle_test/bad.rle");
+        out << "x = 2, y = 1\n2o?!\n";
+    }
+    REQUIRE(loaded.loadRLE("IO/rle_test/bad.rle") == false);
+    REQUIRE(loaded.getPopulation() == 2);
+
+    std::filesystem::remove_all("IO/rle_test");
+}
+
+TEST_CASE("LogReplay seeks and plays a log in both directions") {
+    std::cout << "[TEST] Log replay" << std::endl;
+
+    Life life(96, 40, 3);
+    life.randomize(0.25f, 5);
+    life.setMode(LifeMode::Custom3D);
+
+    LifeLogWriter writer;
+    REQUIRE(writer.open("replay_test.lifl", 96, 40, 3, 8) == true);
+    std::vector<std::vector<uint64_t>> frames;
+    for (int g = 0; g < 30; ++g) {
+        REQUIRE(writer.append(life) == true);
+        frames.push_back(life.getWords());
+        life.update();
+    }
+    writer.close();
+    REQUIRE(std::filesystem::exists("replay_test.lifl.idx"));
+
+    LogReplay replay;
+    REQUIRE(replay.open("replay_test.lifl") == true);
+    REQUIRE(replay.getReader().usedIndex() == true);
+    REQUIRE(replay.getFrameCount() == 30);
+
+    Life shown(1, 1, 1);
+    REQUIRE(replay.seek(17, shown) == true);
+    REQUIRE(shown.getGeneration() == 17);
+    REQUIRE(shown.getWords() == frames[17]);
+    REQUIRE(replay.seek(1000, shown) == true);
+    REQUIRE(replay.getGeneration() == 29);
+
+    // Backward through two keyframes down to the first frame
+    replay.setForward(false);
+    for (int g = 28; g >= 0; --g) {
+        REQUIRE(replay.step(shown) == true);
+        REQUIRE(shown.getGeneration() == g);
+        REQUIRE(shown.getWords() == frames[g]);
+    }
+    REQUIRE(replay.step(shown) == false);
+
+    replay.setForward(true);
+    for (int g = 1; g < 30; ++g) {
+        REQUIRE(replay.step(shown) == true);
+        REQUIRE(shown.getWords() == frames[g]);
+    }
+    REQUIRE(replay.step(shown) == false);
+    REQUIRE(shown.getMode() == LifeMode::Custom3D);
+    replay.close();
+
+    // An index that no longer matches the log is ignored
+    {
+        std::ofstream append("replay_test.lifl", std::ios::binary | std::ios::app);
+        append.put(0);
+    }
+    REQUIRE(replay.open("replay_test.lifl") == true);
+    REQUIRE(replay.getReader().usedIndex() == false);
+    REQUIRE(replay.getFrameCount() == 30);
+    REQUIRE(replay.seek(9, shown) == true);
+    REQUIRE(shown.getWords() == frames[9]);
+    replay.close();
+
+    std::remove("replay_test.lifl");
+    std::remove("replay_test.lifl.idx");
+}
+
+TEST_CASE("Checkpoints restore a run bit-exactly, generator included") {
+    std::cout << "[TEST] Checkpoint and resume" << std::endl;
+
+    Life life(70, 24, 6);
+    life.randomize();
+    life.setMode(LifeMode::Custom3D);
+    life.setToric(true);
+    life.setEngine(LifeEngine::Sparse);
+    for (int g = 0; g < 5; ++g) life.update();
+
+    ViewState view;
+    view.coloring = 2;
+    view.cameraYaw = 12.5f;
+    view.cameraDistance = 42.0f;
+    view.cameraTarget[1] = -3.0f;
+
+    // Written from a copy: the run can move on before the file is done
+    CheckpointWriter writer;
+    writer.submit(Checkpoint::capture(life, "soup", view), "checkpoint_test.lifc");
+    std::vector<uint64_t> savedWords = life.getWords();
+    life.update();
+    writer.flush();
+    REQUIRE(writer.getWritten() == 1);
+    REQUIRE(!std::filesystem::exists("checkpoint_test.lifc.tmp"));
+
+    // A path that cannot be created counts as a failure instead of throwing
+    writer.submit(Checkpoint::capture(life, "soup", view), "checkpoint_test.lifc/inside.lifc");
+    writer.flush();
+    REQUIRE(writer.getFailed() == 1);
+    REQUIRE(writer.getWritten() == 1);
+
+    Checkpoint checkpoint;
+    REQUIRE(checkpoint.load("checkpoint_test.lifc") == true);
+    REQUIRE(checkpoint.name == "soup");
+    REQUIRE(checkpoint.view.coloring == 2);
+    REQUIRE(checkpoint.view.cameraYaw == 12.5f);
+    REQUIRE(checkpoint.view.cameraDistance == 42.0f);
+    REQUIRE(checkpoint.view.cameraTarget[1] == -3.0f);
+
+    Life resumed(1, 1, 1);
+    REQUIRE(checkpoint.restore(resumed) == true);
+    REQUIRE(resumed.getWords() == savedWords);
+    REQUIRE(resumed.getGeneration() == 5);
+    REQUIRE(resumed.getMode() == LifeMode::Custom3D);
+    REQUIRE(resumed.isToric() == true);
+    REQUIRE(resumed.getEngine() == LifeEngine::Sparse);
+
+    // Same next generations and the same random fills as the original run
+    resumed.update();
+    REQUIRE(resumed.getWords() == life.getWords());
+    life.randomize();
+    resumed.randomize();
+    REQUIRE(resumed.getWords() == life.getWords());
+
+    // A damaged checkpoint is rejected and leaves the target untouched
+    {
+        std::fstream f("checkpoint_test.lifc", std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(-1, std::ios::end);
+        f.put('\x5A');
+    }
+    Checkpoint damaged;
+    REQUIRE(damaged.load("checkpoint_test.lifc") == false);
+    REQUIRE(damaged.grid == nullptr);
+
+    // So is one with a damaged header field the checks above cannot catch
+    writer.submit(Checkpoint::capture(life, "soup", view), "checkpoint_test.lifc");
+    writer.flush();
+    REQUIRE(Checkpoint().load("checkpoint_test.lifc") == true);
+    {
+        std::fstream f("checkpoint_test.lifc", std::ios::in | std::ios::out | std::ios::binary);
+        f.seekg(56); // generation
+        char low = char(f.get());
+        f.seekp(56);
+        f.put(char(low ^ 1));
+    }
+    REQUIRE(damaged.load("checkpoint_test.lifc") == false);
+    REQUIRE(damaged.grid == nullptr);
+
+    std::remove("checkpoint_test.lifc");
+}
+
+TEST_CASE("Life revision changes with the cells, and only then") {
+    std::cout << "[TEST] Revision counter" << std::endl;
+
+    Life life(20, 20, 2);
+    uint64_t revision = life.getRevision();
+
+    life.setCell(3, 4, 1, false); // already dead: nothing changed
+    REQUIRE(life.getRevision() == revision);
+    life.setMode(LifeMode::Conway2D);
+    REQUIRE(life.getRevision() == revision);
+
+    life.setCell(3, 4, 1, true);
+    REQUIRE(life.getRevision() != revision);
+    revision = life.getRevision();
+
+    life.clear();
+    REQUIRE(life.getRevision() != revision);
+    revision = life.getRevision();
+
+    // Same generation, different cells: the renderer must still see it
+    long long generation = life.getGeneration();
+    life.setCells({ { 1, 1, 0, true } });
+    LifeSnapshot snapshot;
+    life.snapshot(snapshot);
+    REQUIRE(snapshot.getGeneration() == generation);
+    REQUIRE(snapshot.getRevision() == life.getRevision());
+    REQUIRE(snapshot.getRevision() != revision);
+
+    life.update();
+    REQUIRE(life.getRevision() != snapshot.getRevision());
+}